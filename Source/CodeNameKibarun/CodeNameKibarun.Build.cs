@@ -8,7 +8,7 @@ public class CodeNameKibarun : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "GameplayAbilities", "AIModule", "FCTween" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "GameplayAbilities", "AIModule", "NavigationSystem", "FCTween", "NetCore", "GameplayTags" });
 
 		PrivateDependencyModuleNames.AddRange(new string[] {  });
 
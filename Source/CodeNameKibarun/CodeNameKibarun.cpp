@@ -4,3 +4,9 @@
 #include "Modules/ModuleManager.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, CodeNameKibarun, "CodeNameKibarun" );
+
+DEFINE_LOG_CATEGORY(LogCombat);
+
+UE_TRACE_CHANNEL_DEFINE(CombatChannel);
+
+UE_DEFINE_GAMEPLAY_TAG_COMMENT(TAG_State_Dead, "State.Dead", "The character died and waits to be despawned");
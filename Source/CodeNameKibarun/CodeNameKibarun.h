@@ -3,4 +3,17 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "NativeGameplayTags.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "ProfilingDebugging/MiscTrace.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogCombat, Log, All);
+
+// Combat loop timings, see "stat Combat" and the Combat trace channel in Insights
+DECLARE_STATS_GROUP(TEXT("Combat"), STATGROUP_Combat, STATCAT_Advanced);
+UE_TRACE_CHANNEL_EXTERN(CombatChannel, CODENAMEKIBARUN_API);
+
+// Granted to a character once it died, until it is despawned
+UE_DECLARE_GAMEPLAY_TAG_EXTERN(TAG_State_Dead);
@@ -2,4 +2,38 @@
 
 
 #include "AbilitySystem/Attributes/BaseCharacterAttributeSet.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+
+
+void UBaseCharacterAttributeSet::QueueAttributeChange(const FGameplayAttribute& Attribute, float ChangeDelta, float NewValue, bool HitLimit)
+{
+	for (auto& change : _pendingChanges)
+	{
+		if (change.Attribute == Attribute)
+		{
+			change.ChangeDelta += ChangeDelta;
+			change.NewValue = NewValue;
+			change.HitLimit |= HitLimit;
+			return;
+		}
+	}
+	_pendingChanges.Add({ Attribute, ChangeDelta, NewValue, HitLimit });
+	if (_pendingChanges.Num() > 1)
+		return;
+	// First change since the last flush
+	if (auto world = GetWorld())
+		world->GetTimerManager().SetTimerForNextTick(this, &UBaseCharacterAttributeSet::FlushAttributeChanges_Internal);
+	else
+		FlushAttributeChanges_Internal();
+}
+
+void UBaseCharacterAttributeSet::FlushAttributeChanges_Internal()
+{
+	// Listeners may change attributes again, those changes go to the next flush
+	auto changes = MoveTemp(_pendingChanges);
+	_pendingChanges.Reset();
+	for (const auto& change : changes)
+		BroadcastAttributeChange(change);
+}
 
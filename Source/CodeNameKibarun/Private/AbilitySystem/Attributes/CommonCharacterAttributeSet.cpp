@@ -3,20 +3,60 @@
 
 #include "AbilitySystem/Attributes/CommonCharacterAttributeSet.h"
 #include "GameplayEffectExtension.h"
+#include "Net/UnrealNetwork.h"
 
 
 
 
 void UCommonCharacterAttributeSet::PostGameplayEffectExecute(const FGameplayEffectModCallbackData& Data)
 {
-	if(Data.EvaluatedData.Attribute == GetHealthAttribute())
+	// Only the Blueprint events are fed from here, once per frame
+	if(Data.EvaluatedData.Attribute == GetHealthAttribute() && OnHealthChanged.IsBound())
 	{
 		const float diff = Data.EvaluatedData.Magnitude;
 		const bool reachedLimit = (GetHealth() <= 0 && (GetHealth() - diff) > 0) || (GetHealth() >= GetMaxHealth() && (GetHealth() - diff) < GetMaxHealth());
-		OnHealthChanged.Broadcast(Data.EvaluatedData.Magnitude, GetHealth(), reachedLimit);
+		QueueAttributeChange(GetHealthAttribute(), diff, GetHealth(), reachedLimit);
 	}
-	if(Data.EvaluatedData.Attribute == GetMaxHealthAttribute())
+	if(Data.EvaluatedData.Attribute == GetMaxHealthAttribute() && OnMaxHealthChanged.IsBound())
 	{
-		OnMaxHealthChanged.Broadcast(Data.EvaluatedData.Magnitude, GetMaxHealth(), false);
+		QueueAttributeChange(GetMaxHealthAttribute(), Data.EvaluatedData.Magnitude, GetMaxHealth(), false);
 	}
 }
+
+void UCommonCharacterAttributeSet::PreAttributeChange(const FGameplayAttribute& Attribute, float& NewValue)
+{
+	Super::PreAttributeChange(Attribute, NewValue);
+	if (Attribute == GetMoveSpeedMultiplierAttribute())
+		NewValue = FMath::Max(NewValue, 0.f);
+}
+
+void UCommonCharacterAttributeSet::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME_CONDITION_NOTIFY(UCommonCharacterAttributeSet, MaxHealth, COND_None, REPNOTIFY_Always);
+	DOREPLIFETIME_CONDITION_NOTIFY(UCommonCharacterAttributeSet, Health, COND_None, REPNOTIFY_Always);
+	DOREPLIFETIME_CONDITION_NOTIFY(UCommonCharacterAttributeSet, MoveSpeedMultiplier, COND_None, REPNOTIFY_Always);
+}
+
+void UCommonCharacterAttributeSet::OnRep_MaxHealth(const FGameplayAttributeData& OldValue)
+{
+	GAMEPLAYATTRIBUTE_REPNOTIFY(UCommonCharacterAttributeSet, MaxHealth, OldValue);
+}
+
+void UCommonCharacterAttributeSet::OnRep_Health(const FGameplayAttributeData& OldValue)
+{
+	GAMEPLAYATTRIBUTE_REPNOTIFY(UCommonCharacterAttributeSet, Health, OldValue);
+}
+
+void UCommonCharacterAttributeSet::OnRep_MoveSpeedMultiplier(const FGameplayAttributeData& OldValue)
+{
+	GAMEPLAYATTRIBUTE_REPNOTIFY(UCommonCharacterAttributeSet, MoveSpeedMultiplier, OldValue);
+}
+
+void UCommonCharacterAttributeSet::BroadcastAttributeChange(const FPendingAttributeChange& Change)
+{
+	if (Change.Attribute == GetHealthAttribute())
+		OnHealthChanged.Broadcast(Change.ChangeDelta, Change.NewValue, Change.HitLimit);
+	else if (Change.Attribute == GetMaxHealthAttribute())
+		OnMaxHealthChanged.Broadcast(Change.ChangeDelta, Change.NewValue, Change.HitLimit);
+}
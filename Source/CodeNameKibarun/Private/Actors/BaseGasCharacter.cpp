@@ -6,21 +6,30 @@
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Components/CharacterAnchor.h"
-#include "Blueprint/AIBlueprintHelperLibrary.h"
+#include "SubSystems/AnchorMoveSubsystem.h"
+#include "SubSystems/CombatSubSystem.h"
 #include <GameDataTypes/EnemyData.h>
-#include "FCTweenInstanceVector.h"
+#include "Movement/RootMotionSource_EasedMoveTo.h"
+#include "CodeNameKibarun.h"
+#include "Net/UnrealNetwork.h"
 
 
 // Sets default values
 ABaseGasCharacter::ABaseGasCharacter()
 {
-	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// Nothing to do per frame natively, blueprints can still enable the tick
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 	AbilitySystemComponent = CreateDefaultSubobject<UAbilitySystemComponent>(TEXT("AbilitySystemComponent"));
+	// Attributes and tags follow the server, effects only go to the owning client
+	AbilitySystemComponent->SetIsReplicated(true);
+	AbilitySystemComponent->SetReplicationMode(EGameplayEffectReplicationMode::Mixed);
 	CommonAttributeSet = CreateDefaultSubobject<UCommonCharacterAttributeSet>(TEXT("CommonAttributeSet"));
-	CommonAttributeSet->OnHealthChanged.AddDynamic(this, &ABaseGasCharacter::OnHealthChanged_Internal);
 	SubMesh = CreateDefaultSubobject<USkeletalMeshComponent>("SubMesh");
 	SubMesh->SetupAttachment(GetMesh());
+	// Animations skip frames when far or small on screen
+	GetMesh()->bEnableUpdateRateOptimizations = true;
+	SubMesh->bEnableUpdateRateOptimizations = true;
 	GetCharacterMovement()->bOrientRotationToMovement = true;
 	GetCharacterMovement()->bUseControllerDesiredRotation = false;
 	bUseControllerRotationYaw = false;
@@ -30,10 +39,45 @@ ABaseGasCharacter::ABaseGasCharacter()
 	GetMesh()->SetHiddenInGame(true);
 }
 
-void ABaseGasCharacter::OnHealthChanged_Internal(float ChangeDelta, float NewValue, bool HitLimit)
+void ABaseGasCharacter::OnHealthChanged_Internal(const FOnAttributeChangeData& Data)
 {
-	if (NewValue <= 0 && (NewValue + ChangeDelta) > 0)
-		OnCharacterDied.Broadcast(this);
+	const float maxHealth = CommonAttributeSet->GetMaxHealth();
+	const bool hitLimit = Data.NewValue <= 0 || Data.NewValue >= maxHealth;
+	if (auto combatSubsystem = GetWorld()->GetSubsystem<UCombatSubSystem>())
+	{
+		auto flags = ECombatUIChangeFlags::Health | (hitLimit ? ECombatUIChangeFlags::HitLimit : ECombatUIChangeFlags::None);
+		// Death is server driven, clients only see it through the replicated health
+		if (Data.NewValue <= 0 && !HasAuthority())
+			flags |= ECombatUIChangeFlags::Died;
+		combatSubsystem->ReportUIChange(this, Data.OldValue, Data.NewValue, maxHealth, flags);
+	}
+	if (Data.NewValue <= 0 && HasAuthority())
+		Die();
+}
+
+void ABaseGasCharacter::Die()
+{
+	if (_isDead)
+		return;
+	_isDead = true;
+	// First step of the death pipeline, the combat manager takes over from OnCharacterDied
+	if (AbilitySystemComponent)
+		AbilitySystemComponent->AddLooseGameplayTag(TAG_State_Dead);
+	if (auto combatSubsystem = GetWorld()->GetSubsystem<UCombatSubSystem>())
+	{
+		const float health = CommonAttributeSet ? CommonAttributeSet->GetHealth() : 0;
+		combatSubsystem->ReportUIChange(this, health, health, CommonAttributeSet ? CommonAttributeSet->GetMaxHealth() : 0, ECombatUIChangeFlags::Died);
+	}
+	OnCharacterDied.Broadcast(this);
+}
+
+void ABaseGasCharacter::OnMaxHealthChanged_Internal(const FOnAttributeChangeData& Data)
+{
+	if (auto combatSubsystem = GetWorld()->GetSubsystem<UCombatSubSystem>())
+	{
+		const float health = CommonAttributeSet->GetHealth();
+		combatSubsystem->ReportUIChange(this, health, health, Data.NewValue, ECombatUIChangeFlags::MaxHealth);
+	}
 }
 
 // Called when the game starts or when spawned
@@ -42,14 +86,30 @@ void ABaseGasCharacter::BeginPlay()
 	Super::BeginPlay();
 	if (Anchor)
 		Anchor->SetNewOwner(this);
+	if (auto gameInstance = GetGameInstance())
+	{
+		_statTable = gameInstance->GetSubsystem<UCharacterStatsSubsystem>();
+		if (_statTable)
+			_statIndex = _statTable->RegisterCharacterData(CharacterData);
+	}
+	const FCompiledCharacterStats& stats = GetStats();
 	if (AbilitySystemComponent)
 	{
 		AbilitySystemComponent->InitAbilityActorInfo(this, this);
 		//Initialize Attributes
-		AbilitySystemComponent->SetNumericAttributeBase(UCommonCharacterAttributeSet::GetMaxHealthAttribute(), CharacterData ? CharacterData->Stats.MaxHealth : InitialMaxHealth);
-		AbilitySystemComponent->SetNumericAttributeBase(UCommonCharacterAttributeSet::GetHealthAttribute(), CharacterData ? CharacterData->Stats.MaxHealth : InitialMaxHealth);
+		const float maxHealth = CharacterData ? stats.MaxHealth : InitialMaxHealth;
+		AbilitySystemComponent->SetNumericAttributeBase(UCommonCharacterAttributeSet::GetMaxHealthAttribute(), maxHealth);
+		AbilitySystemComponent->SetNumericAttributeBase(UCommonCharacterAttributeSet::GetHealthAttribute(), maxHealth);
+		// Bound after the initial values, the UI feed gets the changes from there on
+		AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(UCommonCharacterAttributeSet::GetHealthAttribute())
+			.AddUObject(this, &ABaseGasCharacter::OnHealthChanged_Internal);
+		AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(UCommonCharacterAttributeSet::GetMaxHealthAttribute())
+			.AddUObject(this, &ABaseGasCharacter::OnMaxHealthChanged_Internal);
+		AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(UCommonCharacterAttributeSet::GetMoveSpeedMultiplierAttribute())
+			.AddUObject(this, &ABaseGasCharacter::OnMoveSpeedMultiplierChanged_Internal);
 	}
-	GetCharacterMovement()->MaxWalkSpeed = CharacterData ? CharacterData->Stats.OnGroundSpeeds.X : 250;
+	// Right away, the first frame already moves
+	ApplySpeed_Internal();
 }
 
 bool ABaseGasCharacter::MoveToAnchor_Implementation(EMoveToAnchorType movementType, UCharacterAnchor* targetAnchor, EMoveToAnchorType& movingToAnchorType)
@@ -62,56 +122,53 @@ bool ABaseGasCharacter::MoveToAnchor_Implementation(EMoveToAnchorType movementTy
 			break;
 		case EMoveToAnchorType::Walk:
 			{
-				float walkSpeed = GetCharacterMovement()->MaxWalkSpeed;
-				GetCharacterMovement()->MaxWalkSpeed = CharacterData ? CharacterData->Stats.OnGroundSpeeds.X : 250;
+				SetSpeedMode(ECharacterSpeedMode::Walk);
 				if (targetAnchor == Anchor)
 					movingToAnchorType = EMoveToAnchorType::Walk;
-				UAIBlueprintHelperLibrary::SimpleMoveToLocation(GetController(), targetAnchor->GetComponentLocation());
+				if (auto anchorMoves = GetWorld()->GetSubsystem<UAnchorMoveSubsystem>())
+					anchorMoves->RequestAnchorMove(this, targetAnchor->GetComponentLocation());
 			}
 			break;
 		case EMoveToAnchorType::Run:
 			{
-				float runSpeed = GetCharacterMovement()->MaxWalkSpeed;
-				GetCharacterMovement()->MaxWalkSpeed = CharacterData ? CharacterData->Stats.OnGroundSpeeds.Y : 450;
+				SetSpeedMode(ECharacterSpeedMode::Run);
 				if (targetAnchor == Anchor)
 					movingToAnchorType = EMoveToAnchorType::Run;
-				UAIBlueprintHelperLibrary::SimpleMoveToLocation(GetController(), targetAnchor->GetComponentLocation());
+				if (auto anchorMoves = GetWorld()->GetSubsystem<UAnchorMoveSubsystem>())
+					anchorMoves->RequestAnchorMove(this, targetAnchor->GetComponentLocation());
 			}
 			break;
 		case EMoveToAnchorType::Dash:
 			{
-				if (_dashTween != nullptr)
-				{
-					if (_dashTweenVector && _dashTweenVector->bIsActive)
-					{
-						_dashTweenVector->Destroy();
-						_dashTweenVector = nullptr;
-					}
-				}
+				// Dashes are server driven: anchors are assigned on the server, which applies the source and replicates it.
+				// The owning client does not predict them, its movement gets corrected to the server dash
+				// Replace a running dash, and a walk still waiting for its path
+				if (auto anchorMoves = GetWorld()->GetSubsystem<UAnchorMoveSubsystem>())
+					anchorMoves->CancelAnchorMove(this);
+				auto movement = GetCharacterMovement();
+				if (_dashRootMotionID != 0)
+					movement->RemoveRootMotionSourceByID(_dashRootMotionID);
 				if (targetAnchor == Anchor)
 					movingToAnchorType = EMoveToAnchorType::Dash;
-				GetCharacterMovement()->MaxWalkSpeed = 1;
-				_dashTweenVector = FCTween::Play(
-					GetActorLocation(), targetAnchor->GetComponentLocation(), [&](FVector t)
-					{
-						if (auto movement = GetCharacterMovement())
-						{
-							movement->AddInputVector(_dashTweenVector->EndValue - t, false);
-							movement->Velocity = (t - GetActorLocation()) / GetWorld()->DeltaTimeSeconds;
-						}
-					},
-					DashTime,
-					DashEasing);
-				_dashTweenVector->SetDelay(DashDelay);
-				_dashTweenVector->SetOnComplete([&]() { OnAnchorReached(); });
-				_dashTweenVector->SetUseGlobalTimeDilation(true);
-				_dashTween = _dashTweenVector->CreateUObject(this);
+				TSharedPtr<FRootMotionSource_EasedMoveTo> dash = MakeShared<FRootMotionSource_EasedMoveTo>();
+				dash->InstanceName = TEXT("AnchorDash");
+				dash->StartLocation = GetActorLocation();
+				dash->TargetLocation = targetAnchor->GetComponentLocation();
+				dash->Delay = DashDelay;
+				dash->Duration = DashDelay + DashTime;
+				dash->Easing = DashEasing;
+				dash->FinishVelocityParams.Mode = ERootMotionFinishVelocityMode::SetVelocity;
+				dash->FinishVelocityParams.SetVelocity = FVector::ZeroVector;
+				_dashRootMotionID = movement->ApplyRootMotionSource(dash);
+				GetWorldTimerManager().SetTimer(_dashTimerHandle, this, &ABaseGasCharacter::OnDashEnded_Internal, dash->Duration, false);
 			}
 			break;
 		case EMoveToAnchorType::Teleport:
 			{
 				if (targetAnchor == Anchor)
 					movingToAnchorType = EMoveToAnchorType::Teleport;
+				if (auto anchorMoves = GetWorld()->GetSubsystem<UAnchorMoveSubsystem>())
+					anchorMoves->CancelAnchorMove(this);
 				SetActorLocation(targetAnchor->GetComponentLocation(), false, nullptr, ETeleportType::TeleportPhysics);
 				OnAnchorReached();
 			}
@@ -122,6 +179,12 @@ bool ABaseGasCharacter::MoveToAnchor_Implementation(EMoveToAnchorType movementTy
 	return true;
 }
 
+void ABaseGasCharacter::OnDashEnded_Internal()
+{
+	_dashRootMotionID = 0;
+	OnAnchorReached();
+}
+
 // Called every frame
 void ABaseGasCharacter::Tick(float DeltaTime)
 {
@@ -134,6 +197,70 @@ void ABaseGasCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCo
 	Super::SetupPlayerInputComponent(PlayerInputComponent);
 }
 
+void ABaseGasCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME(ABaseGasCharacter, SpeedMode);
+}
+
+void ABaseGasCharacter::SetSpeedMode(ECharacterSpeedMode NewSpeedMode)
+{
+	if (SpeedMode == NewSpeedMode)
+		return;
+	SpeedMode = NewSpeedMode;
+	MarkSpeedDirty();
+}
+
+void ABaseGasCharacter::OnRep_SpeedMode()
+{
+	MarkSpeedDirty();
+}
+
+void ABaseGasCharacter::OnMoveSpeedMultiplierChanged_Internal(const FOnAttributeChangeData& Data)
+{
+	MarkSpeedDirty();
+}
+
+void ABaseGasCharacter::MarkSpeedDirty()
+{
+	if (_isSpeedDirty)
+		return;
+	_isSpeedDirty = true;
+	if (auto world = GetWorld())
+		world->GetTimerManager().SetTimerForNextTick(this, &ABaseGasCharacter::ApplySpeed_Internal);
+}
+
+void ABaseGasCharacter::ApplySpeed_Internal()
+{
+	_isSpeedDirty = false;
+	const FCompiledCharacterStats& stats = GetStats();
+	float speed = stats.WalkSpeed;
+	switch (SpeedMode)
+	{
+		case ECharacterSpeedMode::Run:
+			speed = stats.RunSpeed;
+			break;
+		case ECharacterSpeedMode::Sprint:
+			speed = stats.SprintSpeed;
+			break;
+		default:
+			break;
+	}
+	if (CommonAttributeSet)
+		speed *= CommonAttributeSet->GetMoveSpeedMultiplier();
+	GetCharacterMovement()->MaxWalkSpeed = speed;
+}
+
+void ABaseGasCharacter::ApplySignificance(ECombatSignificance significance, float tickInterval)
+{
+	if (_significance == significance)
+		return;
+	_significance = significance;
+	GetCharacterMovement()->SetComponentTickInterval(tickInterval);
+	GetMesh()->SetComponentTickInterval(tickInterval);
+	SubMesh->SetComponentTickInterval(tickInterval);
+}
+
 void ABaseGasCharacter::SetNewAnchor(UCharacterAnchor* newAnchor)
 {
 	auto oldAnchor = Anchor;
@@ -151,7 +278,7 @@ void ABaseGasCharacter::OnAnchorReached()
 {
 	if (_movingToAnchorType == EMoveToAnchorType::None)
 		return;
-	GetCharacterMovement()->MaxWalkSpeed = CharacterData ? CharacterData->Stats.OnGroundSpeeds.X : 250;
+	SetSpeedMode(ECharacterSpeedMode::Walk);
 	_movingToAnchorType = EMoveToAnchorType::None;
 }
 
@@ -2,20 +2,41 @@
 
 
 #include "Actors/CombatManager.h"
+#include "CodeNameKibarun.h"
 #include "Engine/AssetManager.h"
 #include "GameDataTypes/EnemyData.h"
 #include "GameDataTypes/HeroData.h"
-#include "Kismet/KismetSystemLibrary.h"
+#include "Components/CombatDebugComponent.h"
+#include "Components/CombatSignificanceComponent.h"
 #include <SubSystems/CombatSubSystem.h>
 #include <SubSystems/LevelSubsystem.h>
 #include <Kismet/GameplayStatics.h>
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Net/UnrealNetwork.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+
+DECLARE_CYCLE_STAT(TEXT("Combat Tick"), STAT_CombatTick, STATGROUP_Combat);
+DECLARE_CYCLE_STAT(TEXT("Solve Formation"), STAT_CombatSolveFormation, STATGROUP_Combat);
+DECLARE_CYCLE_STAT(TEXT("Flush Deaths"), STAT_CombatFlushDeaths, STATGROUP_Combat);
+DECLARE_CYCLE_STAT(TEXT("Try Spawn Enemy"), STAT_CombatTrySpawn, STATGROUP_Combat);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies Alive"), STAT_CombatEnemiesAlive, STATGROUP_Combat);
+TRACE_DECLARE_INT_COUNTER(CombatEnemiesAlive, TEXT("Combat/EnemiesAlive"));
 
 
 // Sets default values
 ACombatManager::ACombatManager()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// Only ticks to poll anchors during the phases that need it, see ApplyPhaseSchedule
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	// The server runs the combat, clients follow its replicated state
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	ReplicatedAnchors.Manager = this;
+	ReplicatedEnemies.Manager = this;
+	ReplicatedCursor.Manager = this;
 #if WITH_EDITORONLY_DATA
 	Icon = CreateDefaultSubobject<UBillboardComponent>("Icon");
 	SetRootComponent(Icon);
@@ -26,6 +47,7 @@ ACombatManager::ACombatManager()
 	LevelCameraArm->TargetArmLength = 800;
 	LevelCamera = CreateDefaultSubobject<UCameraComponent>("Level Camera");
 	LevelCamera->SetupAttachment(LevelCameraArm);
+	Significance = CreateDefaultSubobject<UCombatSignificanceComponent>("Significance");
 }
 
 // Called when the game starts or when spawned
@@ -34,29 +56,334 @@ void ACombatManager::BeginPlay()
 	Super::BeginPlay();
 	if (auto world = GetWorld())
 		if (auto subSys = world->GetSubsystem<UCombatSubSystem>())
-			subSys->SetCombatManager(this);
+			subSys->RegisterCombatManager(this);
 
-	// Fade in the black screen
-	FadeCameraCommand(0.f, 1.f, 0, FLinearColor::Black, [&](bool success) {});
+#if ENABLE_DRAW_DEBUG
+	// Debug visualization, toggled by Kibarun.Combat.DebugDraw
+	if (auto debugComponent = NewObject<UCombatDebugComponent>(this, TEXT("CombatDebug")))
+		debugComponent->RegisterComponent();
+#endif
 
-	//Load Stage from level Subsystem
+	// Start on a black screen, faded in once the hero spawns. That only happens on the server, clients are never faded out
+	if (HasAuthority())
+		FadeCameraCommand(0.f, 1.f, 0, FLinearColor::Black);
+
+	NetStats.Reset(GetWorld()->GetTimeSeconds());
+	// Clients need the spawn points too, the enemy proxies are drawn on them
+	BuildWorldSpawns();
+
+	//Load the arena combat, or the Stage from level Subsystem. Clients get it replicated
 	auto mgr = UAssetManager::GetIfInitialized();
-	if (mgr && AutoInitCombat)
+	if (mgr && AutoInitCombat && HasAuthority())
 	{
-		if (auto gameInstance = UGameplayStatics::GetGameInstance(GetWorld()))
+		if (ArenaCombatData.IsValid())
 		{
-			if (auto levelSub = gameInstance->GetSubsystem<ULevelSubsystem>())
+			mgr->LoadPrimaryAsset(ArenaCombatData, { BUNDLE_SPAWN }, FStreamableDelegate::CreateUObject(this, &ACombatManager::OnStageLoaded_Internal, ArenaCombatData));
+		}
+		else if (auto levelSub = GetStageSubsystem())
+		{
+			FPrimaryAssetId stageID = levelSub->GetCurrentStage();
+			if (levelSub->GetPreloadedStage(stageID))
 			{
-				FPrimaryAssetId stageID = levelSub->GetCurrentStage();
-				if (stageID.IsValid())
-				{
-					mgr->LoadPrimaryAsset(stageID, { BUNDLE_SPAWN }, FStreamableDelegate::CreateUObject(this, &ACombatManager::OnStageLoaded_Internal, stageID));
-				}
+				// Already loaded by the previous stage
+				OnStageLoaded_Internal(stageID);
+			}
+			else if (stageID.IsValid())
+			{
+				mgr->LoadPrimaryAsset(stageID, { BUNDLE_SPAWN }, FStreamableDelegate::CreateUObject(this, &ACombatManager::OnStageLoaded_Internal, stageID));
 			}
 		}
 	}
 }
 
+void ACombatManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ReleaseTraversalGrants(false);
+	if (auto world = GetWorld())
+		if (auto subSys = world->GetSubsystem<UCombatSubSystem>())
+			subSys->UnregisterCombatManager(this);
+	Super::EndPlay(EndPlayReason);
+}
+
+void ACombatManager::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME(ACombatManager, CombatDataID);
+	DOREPLIFETIME(ACombatManager, CombatDifficulty);
+	DOREPLIFETIME(ACombatManager, ReplicatedAnchors);
+	DOREPLIFETIME(ACombatManager, ReplicatedEnemies);
+	DOREPLIFETIME(ACombatManager, ReplicatedCursor);
+}
+
+void ACombatManager::OnRep_CombatDataID()
+{
+	auto mgr = UAssetManager::GetIfInitialized();
+	if (!mgr || !CombatDataID.IsValid())
+		return;
+	mgr->LoadPrimaryAsset(CombatDataID, { BUNDLE_SPAWN }, FStreamableDelegate::CreateUObject(this, &ACombatManager::OnClientCombatDataLoaded_Internal, CombatDataID));
+}
+
+void ACombatManager::OnRep_CombatDifficulty()
+{
+	// Enemies spawned by the server get the server scaling
+	if (auto statTable = GetGameInstance() ? GetGameInstance()->GetSubsystem<UCharacterStatsSubsystem>() : nullptr)
+		statTable->SetDifficulty(CombatDifficulty.Difficulty, CombatDifficulty.StageIndex);
+	// The data is not loaded yet on a new combat, the schedule is built once it is
+	if (CombatData && CombatData->GetPrimaryAssetId() == CombatDataID)
+	{
+		BuildWaveSchedule();
+		SyncEnemyProxies();
+	}
+}
+
+void ACombatManager::OnClientCombatDataLoaded_Internal(FPrimaryAssetId stageID)
+{
+	if (HasAuthority() || stageID != CombatDataID)
+		return;
+	const auto mgr = UAssetManager::GetIfInitialized();
+	CombatData = mgr ? mgr->GetPrimaryAssetObject<UCombatData>(stageID) : nullptr;
+	BuildWaveSchedule();
+	PrefetchUpcomingWaves();
+}
+
+void ACombatManager::OnRep_CombatCursor()
+{
+	if (HasAuthority())
+		return;
+	const int32 lastWave = WaveCursor.WaveIndex;
+	WaveCursor.WaveIndex = static_cast<int32>(ReplicatedCursor.WaveIndex) - 1;
+	WaveCursor.EnemyIndex = ReplicatedCursor.EnemyIndex;
+	WaveCursor.bHasBeganSpawn = ReplicatedCursor.bHasBeganSpawn;
+	if (lastWave != WaveCursor.WaveIndex)
+		PrefetchUpcomingWaves();
+	SyncEnemyProxies();
+
+	const ECombatPhase phase = static_cast<ECombatPhase>(ReplicatedCursor.Phase);
+	if (phase != CurrentPhase)
+	{
+		CurrentPhase = phase;
+		OnStateChanged.Broadcast(CurrentPhase);
+	}
+}
+
+void ACombatManager::UpdateReplicatedCursor()
+{
+	if (!HasAuthority())
+		return;
+	ReplicatedCursor.Phase = static_cast<uint8>(CurrentPhase);
+	ReplicatedCursor.WaveIndex = static_cast<uint16>(WaveCursor.WaveIndex + 1);
+	ReplicatedCursor.EnemyIndex = static_cast<uint16>(WaveCursor.EnemyIndex);
+	ReplicatedCursor.bHasBeganSpawn = WaveCursor.bHasBeganSpawn;
+}
+
+void ACombatManager::UpdateReplicatedAnchor(const UCharacterAnchor* anchor)
+{
+	if (!anchor || !HasAuthority())
+		return;
+	const int32 heroIndex = HeroAnchors.IndexOfByKey(anchor);
+	if (heroIndex != INDEX_NONE)
+	{
+		ReplicatedAnchors.SetAnchor(heroIndex, false, anchor);
+		return;
+	}
+	const int32 enemyIndex = EnemyAnchors.IndexOfByKey(anchor);
+	if (enemyIndex != INDEX_NONE)
+		ReplicatedAnchors.SetAnchor(enemyIndex, true, anchor);
+}
+
+void ACombatManager::OnAnchorReplicated(const FReplicatedAnchor& replicatedAnchor)
+{
+	if (HasAuthority())
+		return;
+	// Local anchors only mirror the server ones: no owner, they are just there for queries and debug
+	TArray<TObjectPtr<UCharacterAnchor>>& anchors = replicatedAnchor.bIsEnemy ? EnemyAnchors : HeroAnchors;
+	if (anchors.Num() <= replicatedAnchor.Index)
+		SyncAnchorComponents(anchors, replicatedAnchor.Index + 1, replicatedAnchor.bIsEnemy ? TEXT("EnemyAnchor") : TEXT("HeroAnchor"));
+	if (auto anchor = anchors[replicatedAnchor.Index].Get())
+	{
+		anchor->SetWorldLocation(replicatedAnchor.Location);
+		SpatialGrid.Update(anchor, replicatedAnchor.Location, replicatedAnchor.bIsEnemy ? ECombatSpatialKind::EnemyAnchor : ECombatSpatialKind::HeroAnchor);
+	}
+}
+
+void ACombatManager::BuildWaveSchedule()
+{
+	WaveSchedule = nullptr;
+	if (!CombatData)
+		return;
+	// The server picks the difficulty in InitCombat, clients get it replicated
+	if (CombatDifficulty.Difficulty.KeepsWaves(CombatDifficulty.StageIndex))
+	{
+		WaveSchedule = &CombatData->GetWaveSchedule();
+		return;
+	}
+	ScaledWaveSchedule.Compile(CombatData->EnemyWaves, CombatDifficulty.Difficulty, CombatDifficulty.StageIndex);
+	WaveSchedule = &ScaledWaveSchedule;
+}
+
+void ACombatManager::SyncEnemyProxies()
+{
+	const bool showProxies = bUseEnemyProxies && !bHeadless && GetNetMode() != NM_DedicatedServer;
+	const FCompiledWave* wave = showProxies && WaveSchedule ? WaveCursor.GetWave(*WaveSchedule) : nullptr;
+	const int32 firstWaiting = wave ? wave->FirstEnemy + WaveCursor.EnemyIndex : 0;
+	const int32 waveEnd = wave ? wave->FirstEnemy + wave->EnemyCount : 0;
+
+	// Drop the proxies of the spawned enemies and of the previous wave
+	int32 kept = 0;
+	for (const auto& proxy : EnemyProxies)
+	{
+		if (proxy.EnemyIndex >= firstWaiting && proxy.EnemyIndex < waveEnd)
+			EnemyProxies[kept++] = proxy;
+		else
+			ReleaseEnemyProxy(proxy);
+	}
+	EnemyProxies.SetNum(kept, EAllowShrinking::No);
+
+	const auto mgr = UAssetManager::GetIfInitialized();
+	if (!wave || !mgr)
+		return;
+	for (int32 enemyIndex = EnemyProxies.IsEmpty() ? firstWaiting : EnemyProxies.Last().EnemyIndex + 1; enemyIndex < waveEnd && EnemyProxies.Num() < MaxEnemyProxies; enemyIndex++)
+	{
+		const auto enemyData = mgr->GetPrimaryAssetObject<UEnemyData>(WaveSchedule->Enemies[enemyIndex]);
+		if (!enemyData)
+			break; // Not loaded yet, the prefetch syncs again when done
+		FEnemyProxy& proxy = EnemyProxies.AddDefaulted_GetRef();
+		proxy.EnemyIndex = enemyIndex;
+		proxy.Transform = GetEnemyProxyTransform(enemyIndex - wave->FirstEnemy);
+		UStaticMesh* mesh = enemyData->ProxyMesh.Get();
+		if (!mesh)
+			continue; // No proxy mesh, or not loaded: the enemy still keeps its waiting spot
+		proxy.Pool = ProxyPools.IndexOfByPredicate([mesh](const UInstancedStaticMeshComponent* pool) { return pool && pool->GetStaticMesh() == mesh; });
+		if (proxy.Pool == INDEX_NONE)
+		{
+			auto pool = NewObject<UInstancedStaticMeshComponent>(this, MakeUniqueObjectName(this, UInstancedStaticMeshComponent::StaticClass(), TEXT("EnemyProxies")));
+			pool->SetStaticMesh(mesh);
+			pool->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+			pool->SetCanEverAffectNavigation(false);
+			pool->SetMobility(EComponentMobility::Movable);
+			pool->SetupAttachment(GetRootComponent());
+			pool->RegisterComponent();
+			proxy.Pool = ProxyPools.Add(pool);
+			ProxyFreeInstances.AddDefaulted();
+		}
+		const FTransform instanceTransform = enemyData->ProxyTransform * proxy.Transform;
+		auto pool = ProxyPools[proxy.Pool];
+		if (ProxyFreeInstances[proxy.Pool].IsEmpty())
+			proxy.Instance = pool->AddInstance(instanceTransform, true);
+		else
+		{
+			proxy.Instance = ProxyFreeInstances[proxy.Pool].Pop(EAllowShrinking::No);
+			pool->UpdateInstanceTransform(proxy.Instance, instanceTransform, true, true, true);
+		}
+	}
+}
+
+FTransform ACombatManager::GetEnemyProxyTransform(int32 waveEnemyIndex) const
+{
+	if (WorldEnemySpawns.IsEmpty())
+		return GetActorTransform();
+	// Enemies queue in rows behind the spawn points, the first ones on the points
+	const FTransform& spawn = WorldEnemySpawns[waveEnemyIndex % WorldEnemySpawns.Num()];
+	const int32 row = waveEnemyIndex / WorldEnemySpawns.Num();
+	return FTransform(spawn.GetRotation(), spawn.GetLocation() - spawn.GetRotation().GetForwardVector() * ProxyRowSpacing * row);
+}
+
+void ACombatManager::ReleaseEnemyProxy(const FEnemyProxy& proxy)
+{
+	if (!ProxyPools.IsValidIndex(proxy.Pool) || proxy.Instance == INDEX_NONE)
+		return;
+	// Hidden with a zero scale rather than removed, removing would move the other instances indices
+	if (auto pool = ProxyPools[proxy.Pool].Get())
+	{
+		pool->UpdateInstanceTransform(proxy.Instance, FTransform(FQuat::Identity, proxy.Transform.GetLocation(), FVector::ZeroVector), true, true, true);
+		ProxyFreeInstances[proxy.Pool].Add(proxy.Instance);
+	}
+}
+
+void ACombatManager::PrefetchUpcomingWaves()
+{
+	auto mgr = UAssetManager::GetIfInitialized();
+	if (!mgr || !WaveSchedule)
+		return;
+	TArray<FPrimaryAssetId> enemies;
+	const int32 firstWave = FMath::Max(WaveCursor.WaveIndex, 0);
+	for (int32 wave = firstWave; wave <= firstWave + 1; wave++)
+	{
+		for (const auto& enemyID : WaveSchedule->GetWaveEnemies(wave))
+			enemies.AddUnique(enemyID);
+	}
+	if (enemies.IsEmpty())
+		return;
+	// The new handle keeps the enemies shared with the previous one loaded
+	WavePrefetchHandle = mgr->LoadPrimaryAssets(enemies, { BUNDLE_SPAWN, BUNDLE_PROXY }, FStreamableDelegate::CreateUObject(this, &ACombatManager::SyncEnemyProxies));
+}
+
+ULevelSubsystem* ACombatManager::GetStageSubsystem() const
+{
+	if (ArenaCombatData.IsValid())
+		return nullptr;
+	auto gameInstance = UGameplayStatics::GetGameInstance(GetWorld());
+	return gameInstance ? gameInstance->GetSubsystem<ULevelSubsystem>() : nullptr;
+}
+
+APlayerController* ACombatManager::GetCombatPlayerController() const
+{
+	return UGameplayStatics::GetPlayerController(this, PlayerIndex);
+}
+
+const FCombatSpatialGrid& ACombatManager::GetSpatialGrid()
+{
+	UpdateSpatialGrid();
+	return SpatialGrid;
+}
+
+void ACombatManager::UpdateSpatialGrid()
+{
+	if (SpatialGridFrame == GFrameCounter)
+		return;
+	SpatialGridFrame = GFrameCounter;
+	// Only characters crossing a cell are rebucketed
+	for (auto hero : HeroesInScene)
+	{
+		if (!hero)
+			continue;
+		if (hero->IsCharacterAlive())
+			SpatialGrid.Update(hero, hero->GetActorLocation(), ECombatSpatialKind::Hero);
+		else
+			SpatialGrid.Remove(hero);
+	}
+	for (auto enemy : EnemiesInScene)
+	{
+		if (!enemy)
+			continue;
+		if (enemy->IsCharacterAlive())
+			SpatialGrid.Update(enemy, enemy->GetActorLocation(), ECombatSpatialKind::Enemy);
+		else
+			SpatialGrid.Remove(enemy);
+	}
+	SpatialGrid.RemoveStale();
+}
+
+UCharacterAnchor* ACombatManager::FindFirstFreeAnchorAlongLine(FVector start, FVector end, float radius, bool enemyAnchors)
+{
+	TArray<UObject*> anchors;
+	GetSpatialGrid().QueryLine(start, end, radius, enemyAnchors ? ECombatSpatialKind::EnemyAnchor : ECombatSpatialKind::HeroAnchor, anchors);
+	for (auto object : anchors)
+	{
+		auto anchor = Cast<UCharacterAnchor>(object);
+		if (anchor && anchor->GetAnchorState() == EAnchorState::Free)
+			return anchor;
+	}
+	return nullptr;
+}
+
+void ACombatManager::RegisterCombatActor(AActor* actor)
+{
+	if (auto world = GetWorld())
+		if (auto subSys = world->GetSubsystem<UCombatSubSystem>())
+			subSys->RegisterCombatActor(actor, this);
+}
+
 void ACombatManager::OnStageLoaded_Internal(FPrimaryAssetId stageID)
 {
 	const auto mgr = UAssetManager::GetIfInitialized();
@@ -77,31 +404,22 @@ void ACombatManager::OnHeroPlayerLoaded_Internal(FPrimaryAssetId heroID, FTransf
 	ABaseGasCharacter* heroActor = SpawnCharacter(heroData, Spawn, charAnchor);
 	if (!heroActor)
 		return;
-	HeroesInScene.Add(heroActor);
+	AddHeroToCombat(heroActor);
 
-	//Make them do the intro traversal
-	bool madeTraversalIntro = false;
-	if (CombatData)
-	{
-		auto traversal = CombatData->PlayerIntroTraversal.Get();
-		//Load the traversal if not already loaded
-		if (!traversal)
-			traversal = CombatData->PlayerIntroTraversal.LoadSynchronous();
-		//Set the traversal to the Hero
-		if (traversal)
-		{
-			if (auto abilitySystem = heroActor->GetAbilitySystemComponent())
-			{
-				//Give the traversal ability to the Hero
-				auto spec = FGameplayAbilitySpec(traversal, 1, -1, heroActor);
-				auto handle = abilitySystem->GiveAbilityAndActivateOnce(spec);
-				madeTraversalIntro = handle.IsValid();
-			}
-		}
+	if (bHeadless)
+	{
+		// No player and no traversal, straight to the anchor
+		heroActor->TryMoveToAnchor(EMoveToAnchorType::Teleport);
+		OnPlayerSpawn.Broadcast(heroActor);
+		return;
 	}
 
+	//Make them do the intro traversal
+	PreGrantTraversals(heroActor);
+	const bool madeTraversalIntro = CombatData && ActivateTraversal(heroActor, CombatData->PlayerIntroTraversal);
+
 	//Snap to the Player's Camera
-	if (auto plController = GetWorld()->GetFirstPlayerController())
+	if (auto plController = GetCombatPlayerController())
 	{
 		plController->Possess(heroActor);
 		if (!madeTraversalIntro)
@@ -109,11 +427,65 @@ void ACombatManager::OnHeroPlayerLoaded_Internal(FPrimaryAssetId heroID, FTransf
 	}
 
 	// Fade in the black screen
-	FadeCameraCommand(1.f, 0.f, CameraFadeTime, FLinearColor::Black, [&](bool success) {});
+	FadeCameraCommand(1.f, 0.f, CameraFadeTime, FLinearColor::Black);
 
 	OnPlayerSpawn.Broadcast(heroActor);
 }
 
+FGameplayAbilitySpecHandle ACombatManager::GrantTraversal(ABaseGasCharacter* hero, TSubclassOf<UGameplayAbility> traversal)
+{
+	auto abilitySystem = hero ? hero->GetAbilitySystemComponent() : nullptr;
+	if (!abilitySystem || !traversal || !HasAuthority())
+		return FGameplayAbilitySpecHandle();
+	for (const auto& grant : TraversalGrants)
+	{
+		if (grant.AbilitySystem == abilitySystem && grant.Ability == traversal && abilitySystem->FindAbilitySpecFromHandle(grant.Handle))
+			return grant.Handle;
+	}
+	//Give the traversal ability to the Hero, it stays granted for the next stages
+	const auto handle = abilitySystem->GiveAbility(FGameplayAbilitySpec(traversal, 1, -1, hero));
+	if (handle.IsValid())
+		TraversalGrants.Add({ abilitySystem, traversal, handle });
+	return handle;
+}
+
+void ACombatManager::PreGrantTraversals(ABaseGasCharacter* hero)
+{
+	if (!CombatData)
+		return;
+	// Only the already loaded ones, the spawn bundle of the combat data brings them in
+	GrantTraversal(hero, CombatData->PlayerIntroTraversal.Get());
+	if (!_wasLastStage)
+		GrantTraversal(hero, CombatData->PlayerOutroTraversal.Get());
+}
+
+bool ACombatManager::ActivateTraversal(ABaseGasCharacter* hero, const TSoftClassPtr<UGameplayAbility>& traversal)
+{
+	auto abilitySystem = hero ? hero->GetAbilitySystemComponent() : nullptr;
+	if (!abilitySystem || traversal.IsNull())
+		return false;
+	auto traversalClass = traversal.Get();
+	//Load the traversal if not already loaded
+	if (!traversalClass)
+		traversalClass = traversal.LoadSynchronous();
+	const auto handle = GrantTraversal(hero, traversalClass);
+	return handle.IsValid() && abilitySystem->TryActivateAbility(handle);
+}
+
+void ACombatManager::ReleaseTraversalGrants(bool bKeepStageTraversals)
+{
+	for (int32 i = TraversalGrants.Num() - 1; i >= 0; i--)
+	{
+		const auto& grant = TraversalGrants[i];
+		const bool isStageTraversal = CombatData && (grant.Ability == CombatData->PlayerIntroTraversal.Get() || grant.Ability == CombatData->PlayerOutroTraversal.Get());
+		if (bKeepStageTraversals && isStageTraversal && grant.AbilitySystem.IsValid())
+			continue;
+		if (auto abilitySystem = grant.AbilitySystem.Get())
+			abilitySystem->ClearAbility(grant.Handle);
+		TraversalGrants.RemoveAtSwap(i);
+	}
+}
+
 void ACombatManager::OnHeroLoaded_Internal(FPrimaryAssetId heroID, FTransform Spawn, UCharacterAnchor* charAnchor)
 {
 	const auto mgr = UAssetManager::GetIfInitialized();
@@ -125,51 +497,176 @@ void ACombatManager::OnHeroLoaded_Internal(FPrimaryAssetId heroID, FTransform Sp
 	auto hero = SpawnCharacter(heroData, Spawn, charAnchor);
 	if (!hero)
 		return;
-	HeroesInScene.Add(hero);
+	AddHeroToCombat(hero);
 	hero->TryMoveToAnchor(EMoveToAnchorType::Teleport);
 }
 
-void ACombatManager::OnEnemyLoaded_Internal(FPrimaryAssetId enemyID, FTransform Spawn, UCharacterAnchor* charAnchor)
+void ACombatManager::OnEnemyLoaded_Internal(FPrimaryAssetId enemyID, FTransform Spawn, UCharacterAnchor* charAnchor, double requestTime)
 {
-	bIsSpawning = false;
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(ACombatManager_OnEnemyLoaded, CombatChannel);
+	SpawnReservedAnchors.Remove(charAnchor);
+	// The kept anchor is out of the formation, but it can be gone with the anchors placement
+	if (!charAnchor || charAnchor->GetAnchorState() != EAnchorState::Free)
+		charAnchor = FindSpawnAnchor();
+	if (!charAnchor)
+	{
+		// Never spawn an enemy without anchor, hold it until one frees up
+		HeldEnemySpawns.Add({ enemyID, Spawn, requestTime });
+		return;
+	}
+	InFlightSpawns = FMath::Max(0, InFlightSpawns - 1);
+	const double now = FPlatformTime::Seconds();
+	Telemetry.AssetLatency.Add(now - requestTime);
 	const auto mgr = UAssetManager::GetIfInitialized();
-	if (!mgr)
+	const auto enemyData = mgr ? mgr->GetPrimaryAssetObject<UEnemyData>(enemyID) : nullptr;
+	if (auto enemyActor = enemyData ? SpawnCharacter(enemyData, Spawn, charAnchor) : nullptr)
+		AddEnemyToCombat(enemyActor, enemyID);
+	// Ready for the next one
+	ScheduleSpawn();
+}
+
+void ACombatManager::AddHeroToCombat(ABaseGasCharacter* hero)
+{
+	if (!hero)
 		return;
-	const auto enemyData = mgr->GetPrimaryAssetObject<UEnemyData>(enemyID);
-	if (!enemyData)
+	HeroesInScene.Add(hero);
+	RegisterCombatActor(hero);
+	hero->OnDestroyed.AddUniqueDynamic(this, &ACombatManager::OnHeroDestroyed_Internal);
+	hero->OnCharacterDied.AddUniqueDynamic(this, &ACombatManager::OnCharacterDied_Internal);
+}
+
+void ACombatManager::AddEnemyToCombat(ABaseGasCharacter* enemy, const FPrimaryAssetId& enemyID)
+{
+	if (!enemy)
 		return;
-	auto enemyActor = SpawnCharacter(enemyData, Spawn, charAnchor);
-	if (enemyActor)
-	{
-		EnemiesInScene.Add(enemyActor);
-		enemyActor->OnDestroyed.AddDynamic(this, &ACombatManager::OnEnemyDestroyed_Internal);
-	}
+	EnemiesInScene.Add(enemy);
+	ReplicatedEnemies.AddEnemy(enemy, enemyID, static_cast<uint16>(FMath::Max(WaveCursor.WaveIndex, 0)));
+	RegisterCombatActor(enemy);
+	enemy->OnDestroyed.AddUniqueDynamic(this, &ACombatManager::OnEnemyDestroyed_Internal);
+	enemy->OnCharacterDied.AddUniqueDynamic(this, &ACombatManager::OnCharacterDied_Internal);
+	Telemetry.PendingAnchorArrivals.Add(enemy, FPlatformTime::Seconds());
+	UpdateAliveEnemiesTelemetry();
 }
 
 void ACombatManager::OnEnemyDestroyed_Internal(AActor* actor)
 {
+	if (auto world = GetWorld())
+		if (auto subSys = world->GetSubsystem<UCombatSubSystem>())
+			subSys->UnregisterCombatActor(actor);
+	SpatialGrid.Remove(actor);
+	ReplicatedEnemies.RemoveEnemy(actor);
+	Telemetry.PendingAnchorArrivals.Remove(actor);
 	int index = EnemiesInScene.IndexOfByKey(actor);
 	if (EnemiesInScene.IsValidIndex(index))
 	{
 		EnemiesInScene.RemoveAt(index);
 	}
+	UpdateAliveEnemiesTelemetry();
 }
 
-void ACombatManager::OnCameraMoveCommand_Internal()
+void ACombatManager::OnHeroDestroyed_Internal(AActor* actor)
 {
-	if (OnCameraMoveEnded)
+	if (auto world = GetWorld())
+		if (auto subSys = world->GetSubsystem<UCombatSubSystem>())
+			subSys->UnregisterCombatActor(actor);
+	SpatialGrid.Remove(actor);
+	HeroesInScene.RemoveSingle(Cast<ABaseGasCharacter>(actor));
+}
+
+void ACombatManager::OnCharacterDied_Internal(AActor* actor)
+{
+	// The dead tag is already set, the rest of the pipeline runs once per frame for all the deaths
+	if (auto character = Cast<ABaseGasCharacter>(actor))
+		PendingDeaths.AddUnique(character);
+	if (GetWorld() && !GetWorldTimerManager().TimerExists(DeathFlushHandle))
+		DeathFlushHandle = GetWorldTimerManager().SetTimerForNextTick(this, &ACombatManager::FlushDeaths);
+}
+
+void ACombatManager::FlushDeaths()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatFlushDeaths);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(ACombatManager_FlushDeaths, CombatChannel);
+	DeathFlushHandle.Invalidate();
+	if (PendingDeaths.IsEmpty())
+		return;
+	UCombatSubSystem* subSys = GetWorld() ? GetWorld()->GetSubsystem<UCombatSubSystem>() : nullptr;
+	TArray<ABaseGasCharacter*> diedCharacters;
+	diedCharacters.Reserve(PendingDeaths.Num());
+	for (const auto& pendingDeath : PendingDeaths)
 	{
-		OnCameraMoveEnded(true);
-		OnCameraMoveEnded.Reset();
+		ABaseGasCharacter* character = pendingDeath.Get();
+		if (!character)
+			continue;
+		// Free the anchor for the next enemy
+		if (character->Anchor && character->Anchor->GetBaseOwnwer() == character)
+			character->Anchor->SetNewOwner(nullptr);
+		character->OnCharacterDied.RemoveDynamic(this, &ACombatManager::OnCharacterDied_Internal);
+		SpatialGrid.Remove(character);
+		diedCharacters.Add(character);
+		// Dead heroes stay in the scene, the end of the combat handles them
+		if (HeroesInScene.Contains(character))
+			continue;
+		// Out of the roster, spawn checks don't see it anymore
+		EnemiesInScene.Remove(character);
+		ReplicatedEnemies.RemoveEnemy(character);
+		Telemetry.PendingAnchorArrivals.Remove(character);
+		if (subSys)
+			subSys->UnregisterCombatActor(character);
+		character->OnDestroyed.RemoveDynamic(this, &ACombatManager::OnEnemyDestroyed_Internal);
+		DespawnDeadCharacter(character);
 	}
+	PendingDeaths.Reset();
+	UpdateAliveEnemiesTelemetry();
+	if (!diedCharacters.IsEmpty())
+		OnCharactersDied.Broadcast(diedCharacters);
+	ScheduleSpawn();
 }
 
-void ACombatManager::OnCameraFadeCommand_Internal()
+void ACombatManager::DespawnDeadCharacter_Implementation(ABaseGasCharacter* character)
 {
-	if (OnCameraFadeEnded)
+	if (!character)
+		return;
+	if (DeadDespawnDelay > 0)
+		character->SetLifeSpan(DeadDespawnDelay);
+	else
+		character->Destroy();
+}
+
+void ACombatManager::OnCameraCommandTimer_Internal()
+{
+	CameraCommandTimer.Invalidate();
+	if (!CameraCommands.IsEmpty())
+		CompleteCameraCommand(0, true);
+	ProcessCameraCommands();
+}
+
+void ACombatManager::OnCameraCommandEnded(ECameraCommandEvent event, bool success)
+{
+	switch (event)
 	{
-		OnCameraFadeEnded(true);
-		OnCameraFadeEnded.Reset();
+		case ECameraCommandEvent::BeginingCameraReady:
+			if (success)
+			{
+				if (CurrentPhase == ECombatPhase::Begining)
+				{
+					OnPhaseEnded.Broadcast(ECombatPhase::Begining);
+				}
+				SetCombatPhase(ECombatPhase::Active);
+			}
+			break;
+		case ECameraCommandEvent::EndingCameraReady:
+			OnPhaseEnded.Broadcast(ECombatPhase::Ending);
+			if (!bMadeTraversalOutro)
+			{
+				//If the outro traversal is not set, just execute end combat
+				EndCombat();
+			}
+			break;
+		case ECameraCommandEvent::EndedFadeCompleted:
+			OnPhaseEnded.Broadcast(ECombatPhase::Ended);
+			break;
+		default:
+			break;
 	}
 }
 
@@ -177,188 +674,416 @@ void ACombatManager::SetCombatPhase(ECombatPhase phase)
 {
 	const auto lastPhase = CurrentPhase;
 	CurrentPhase = phase;
-	if (lastPhase != phase)
-		OnStateChanged.Broadcast(CurrentPhase);
+	if (lastPhase == phase)
+		return;
+	Telemetry.SwitchPhase(static_cast<uint8>(lastPhase), FPlatformTime::Seconds());
+	TRACE_BOOKMARK(TEXT("%s: %s"), *GetName(), *StaticEnum<ECombatPhase>()->GetNameStringByValue(static_cast<int64>(phase)));
+	UpdateReplicatedCursor();
+	ApplyPhaseSchedule(phase);
+
+	// The outcome of the combat is near, get the next stages ready
+	if (phase == ECombatPhase::Active || phase == ECombatPhase::Ending)
+	{
+		if (auto levelSub = GetStageSubsystem())
+			levelSub->PreloadUpcomingStages();
+	}
+	OnStateChanged.Broadcast(CurrentPhase);
 }
 
 // Called every frame
 void ACombatManager::Tick(float DeltaTime)
 {
+	SCOPE_CYCLE_COUNTER(STAT_CombatTick);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(ACombatManager_Tick, CombatChannel);
 	Super::Tick(DeltaTime);
 
 	UpdateAnchors(DeltaTime);
+}
 
-	for (auto anchor : HeroAnchors)
-	{
-		FLinearColor color = anchor->GetAnchorState() == EAnchorState::Free ? FLinearColor::Green : (anchor->GetAnchorState() == EAnchorState::Occupied ? FLinearColor::Red : FLinearColor::Blue);
-		UKismetSystemLibrary::DrawDebugSphere(this, GetActorTransform().TransformPosition(anchor->GetRelativeLocation()), 100.f, 12, color, 0, 1.f);
-	}
+void ACombatManager::UpdateAliveEnemiesTelemetry()
+{
+	const int32 aliveCount = CountAliveEnemies();
+	Telemetry.PeakEnemiesAlive = FMath::Max(Telemetry.PeakEnemiesAlive, aliveCount);
+	TRACE_COUNTER_SET(CombatEnemiesAlive, aliveCount);
+	SET_DWORD_STAT(STAT_CombatEnemiesAlive, aliveCount);
+}
 
-	for (auto anchor : EnemyAnchors)
+int32 ACombatManager::CountAliveEnemies() const
+{
+	int32 aliveCount = 0;
+	for (auto enemy : EnemiesInScene)
 	{
-		FLinearColor color = anchor->GetAnchorState() == EAnchorState::Free ? FLinearColor::Green : (anchor->GetAnchorState() == EAnchorState::Occupied ? FLinearColor::Red : FLinearColor::Blue);
-		UKismetSystemLibrary::DrawDebugSphere(this, GetActorTransform().TransformPosition(anchor->GetRelativeLocation()), 100.f, 12, color, 0, 1.f);
+		if (enemy && enemy->IsCharacterAlive())
+			aliveCount++;
 	}
+	return aliveCount;
 }
 
 void ACombatManager::UpdateAnchors(float DeltaTime)
 {
-	// Update Anchors
-	for (int i = 0; i < HeroAnchors.Num(); i++)
+	// Anchors broadcast their changes, handled by OnAnchorStateChanged_Internal
+	for (auto anchor : HeroAnchors)
+		if (anchor) anchor->UpdateAnchor();
+	for (auto anchor : EnemyAnchors)
+		if (anchor) anchor->UpdateAnchor();
+}
+
+void ACombatManager::OnAnchorStateChanged_Internal(UCharacterAnchor* anchor, EAnchorState lastState, EAnchorState newState)
+{
+	UpdateReplicatedAnchor(anchor);
+	if (HeroAnchors.IsValidIndex(0) && anchor == HeroAnchors[0])
 	{
-		bool changed = HeroAnchors[i]->UpdateAnchor();
-		if (changed)
+		if (CurrentPhase == ECombatPhase::Opening && newState == EAnchorState::Occupied)
 		{
-			if (i == 0)
-			{
-				if (CurrentPhase == ECombatPhase::Opening && HeroAnchors[i]->GetAnchorState() == EAnchorState::Occupied)
-				{
-					SpawnAllies();
-					CreateNextWave();
-				}
-			}
+			SpawnAllies();
+			CreateNextWave();
 		}
+		return;
 	}
 
-	for (int i = 0; i < EnemyAnchors.Num(); i++)
+	const int32 index = EnemyAnchors.IndexOfByKey(anchor);
+	if (index == INDEX_NONE)
+		return;
+	if (newState == EAnchorState::Occupied)
+	{
+		double spawnTime = 0;
+		if (Telemetry.PendingAnchorArrivals.RemoveAndCopyValue(anchor->GetBaseOwnwer(), spawnTime))
+			Telemetry.SpawnToAnchor.Add(FPlatformTime::Seconds() - spawnTime);
+	}
+	if (index == EnemyAnchors.Num() - 1 && newState == EAnchorState::Occupied && CurrentPhase == ECombatPhase::Opening)
+		OnPhaseEnded.Broadcast(ECombatPhase::Opening);
+	// Only an anchor taken or released changes the formation, owners reaching or leaving it don't
+	if (lastState == EAnchorState::Free || newState == EAnchorState::Free)
+		MarkFormationDirty();
+}
+
+void ACombatManager::MarkFormationDirty()
+{
+	// Moving owners raises anchor events, which land back here
+	if (bIsSolvingFormation)
+		return;
+	bIsFormationDirty = true;
+	if (GetWorld() && !GetWorldTimerManager().TimerExists(FormationTimerHandle))
+		FormationTimerHandle = GetWorldTimerManager().SetTimerForNextTick(this, &ACombatManager::SolveEnemyFormation);
+}
+
+void ACombatManager::SolveEnemyFormation()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatSolveFormation);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(ACombatManager_SolveEnemyFormation, CombatChannel);
+	FormationTimerHandle.Invalidate();
+	if (!bIsFormationDirty)
+		return;
+	bIsFormationDirty = false;
+	TGuardValue<bool> solveGuard(bIsSolvingFormation, true);
+
+	TArray<FCombatAnchorSlot, TInlineAllocator<32>> slots;
+	TArray<UCharacterAnchor*, TInlineAllocator<32>> anchors;
+	GatherAnchorSlots(slots, anchors);
+	TArray<TPair<int32, int32>> moves;
+	if (CombatRules.SolveFormation(slots, moves))
 	{
-		bool changed = EnemyAnchors[i]->UpdateAnchor();
-		bool isLast = i >= EnemyAnchors.Num() - 1;
-		switch (EnemyAnchors[i]->GetAnchorState())
+		// Release every anchor changing hands before giving it its new owner
+		TArray<ABaseGasCharacter*, TInlineAllocator<32>> movingCharacters;
+		for (const auto& move : moves)
 		{
-			case EAnchorState::Free:
-				{
-					if (isLast)
-					{
-						if (CurrentPhase == ECombatPhase::Active || CurrentPhase == ECombatPhase::Opening)
-						{
-							TrySpawnEnemy(DeltaTime);
-						}
-					}
-					else
-					{
-						if (auto owner = EnemyAnchors[i + 1]->GetBaseOwnwer())
-						{
-							EnemyAnchors[i + 1]->SetNewOwner(nullptr);
-							EnemyAnchors[i]->SetNewOwner(owner);
-						}
-					}
-				}
-				break;
-			case EAnchorState::Occupied: {
-					if (isLast && changed)
-					{
-						if (CurrentPhase == ECombatPhase::Opening)
-						{
-							OnPhaseEnded.Broadcast(ECombatPhase::Opening);
-						}
-					}
-				}break;
+			movingCharacters.Add(anchors[move.Key]->GetBaseOwnwer());
+			anchors[move.Key]->SetNewOwner(nullptr);
 		}
+		for (int32 i = 0; i < moves.Num(); i++)
+			anchors[moves[i].Value]->SetNewOwner(movingCharacters[i]);
 	}
+	ScheduleSpawn();
 }
 
-void ACombatManager::MoveCameraCommand(AActor* target, const float blendTime, TFunction<void(bool)> onCameraMoveEnded)
+void ACombatManager::ScheduleSpawn()
 {
-	if (OnCameraMoveEnded)
+	if (!HasAuthority() || !FCombatRules::SpawnsDuring(CurrentPhase))
+		return;
+	if (!FindSpawnAnchor())
+		return;
+	const FCompiledWave* wave = WaveSchedule ? WaveCursor.GetWave(*WaveSchedule) : nullptr;
+	if (wave && InFlightSpawns >= wave->MaxInFlightSpawns && HeldEnemySpawns.IsEmpty())
+		return;
+	auto& timerManager = GetWorldTimerManager();
+	if (timerManager.TimerExists(SpawnTimerHandle))
+		return;
+	if (SpawnTimer > 0)
+		timerManager.SetTimer(SpawnTimerHandle, this, &ACombatManager::OnSpawnTimer_Internal, SpawnTimer, false);
+	else
+		SpawnTimerHandle = timerManager.SetTimerForNextTick(this, &ACombatManager::OnSpawnTimer_Internal);
+}
+
+void ACombatManager::OnSpawnTimer_Internal()
+{
+	SpawnTimerHandle.Invalidate();
+	SpawnTimer = 0;
+	if (!FCombatRules::SpawnsDuring(CurrentPhase))
+		return;
+	// Held enemies are already loaded, they take the freed anchors first
+	while (!HeldEnemySpawns.IsEmpty() && FindSpawnAnchor())
 	{
-		OnCameraMoveEnded(false);
-		OnCameraMoveEnded.Reset();
+		const FHeldEnemySpawn held = HeldEnemySpawns[0];
+		HeldEnemySpawns.RemoveAt(0, 1, EAllowShrinking::No);
+		OnEnemyLoaded_Internal(held.EnemyID, held.Spawn, nullptr, held.RequestTime);
 	}
-	if (!target || !GetWorld() || !GetWorld()->GetFirstPlayerController())
+	if (FindSpawnAnchor())
+		TrySpawnEnemy();
+}
+
+void ACombatManager::ApplyPhaseSchedule(ECombatPhase phase)
+{
+	// Anchors are event driven, the tick only polls them as a safety net while characters move around
+	const bool needsPolling = phase == ECombatPhase::Opening || phase == ECombatPhase::Begining || phase == ECombatPhase::Active;
+	SetActorTickInterval(AnchorPollInterval);
+	SetActorTickEnabled(needsPolling);
+
+	if (FCombatRules::SpawnsDuring(phase))
+		ScheduleSpawn();
+	else if (GetWorld())
+		GetWorldTimerManager().ClearTimer(SpawnTimerHandle);
+}
+
+uint32 ACombatManager::MoveCameraCommand(AActor* target, const float blendTime, ECameraCommandEvent onCameraMoveEnded)
+{
+	FCameraCommand& command = CameraCommands.AddDefaulted_GetRef();
+	command.Handle = ++LastCameraCommandHandle;
+	command.Type = ECameraCommandType::Move;
+	command.Target = target;
+	command.Duration = blendTime;
+	command.OnEnded = onCameraMoveEnded;
+	const uint32 handle = command.Handle;
+	ProcessCameraCommands();
+	return handle;
+}
+
+uint32 ACombatManager::FadeCameraCommand(const float fromAlpha, const float toAlpha, const float fadeTime, FLinearColor color, ECameraCommandEvent onCameraFadeEnded)
+{
+	FCameraCommand& command = CameraCommands.AddDefaulted_GetRef();
+	command.Handle = ++LastCameraCommandHandle;
+	command.Type = ECameraCommandType::Fade;
+	command.Duration = fadeTime;
+	command.FromAlpha = fromAlpha;
+	command.ToAlpha = toAlpha;
+	command.Color = color;
+	command.OnEnded = onCameraFadeEnded;
+	const uint32 handle = command.Handle;
+	ProcessCameraCommands();
+	return handle;
+}
+
+bool ACombatManager::CancelCameraCommand(uint32 handle)
+{
+	const int32 index = CameraCommands.IndexOfByPredicate([handle](const FCameraCommand& command) { return command.Handle == handle; });
+	if (index == INDEX_NONE)
+		return false;
+	if (index == 0 && GetWorld())
+		GetWorldTimerManager().ClearTimer(CameraCommandTimer);
+	CompleteCameraCommand(index, false);
+	ProcessCameraCommands();
+	return true;
+}
+
+void ACombatManager::CancelCameraCommands()
+{
+	if (GetWorld())
+		GetWorldTimerManager().ClearTimer(CameraCommandTimer);
+	while (!CameraCommands.IsEmpty())
+		CompleteCameraCommand(CameraCommands.Num() - 1, false);
+}
+
+void ACombatManager::ProcessCameraCommands()
+{
+	// Completions can queue new commands, they are picked by the loop below
+	if (bIsProcessingCameraCommands || !GetWorld() || GetWorldTimerManager().IsTimerActive(CameraCommandTimer))
 		return;
-	if (auto plController = GetWorld()->GetFirstPlayerController())
+	TGuardValue<bool> processGuard(bIsProcessingCameraCommands, true);
+	while (!CameraCommands.IsEmpty())
 	{
-		plController->SetViewTargetWithBlend(target, blendTime, VTBlend_Cubic);
-		OnCameraMoveEnded = onCameraMoveEnded;
-		FTimerHandle hdl;
-		GetWorld()->GetTimerManager().SetTimer(hdl, [&]()->void {OnCameraMoveCommand_Internal(); }, blendTime, false);
+		const float duration = ExecuteCameraCommand(CameraCommands[0]);
+		if (duration > 0)
+		{
+			GetWorldTimerManager().SetTimer(CameraCommandTimer, this, &ACombatManager::OnCameraCommandTimer_Internal, duration, false);
+			return;
+		}
+		// Instant or impossible, done right away
+		CompleteCameraCommand(0, duration >= 0);
 	}
 }
 
-void ACombatManager::FadeCameraCommand(const float fromAlpha, const float toAlpha, const float fadeTime, FLinearColor color, TFunction<void(bool)> onCameraFadeEnded)
+float ACombatManager::ExecuteCameraCommand(const FCameraCommand& command)
 {
-	if (OnCameraFadeEnded)
+	// Nothing to look at, the camera is always ready
+	if (bHeadless)
+		return 0;
+	auto plController = GetCombatPlayerController();
+	if (!plController)
+		return -1;
+	switch (command.Type)
 	{
-		OnCameraFadeEnded(false);
-		OnCameraFadeEnded.Reset();
+		case ECameraCommandType::Move:
+			if (!command.Target.IsValid())
+				return -1;
+			plController->SetViewTargetWithBlend(command.Target.Get(), command.Duration, VTBlend_Cubic);
+			return command.Duration;
+		case ECameraCommandType::Fade:
+			if (!plController->PlayerCameraManager)
+				return -1;
+			plController->PlayerCameraManager->StartCameraFade(command.FromAlpha, command.ToAlpha, command.Duration, command.Color, true, true);
+			return command.Duration;
 	}
-	if (!GetWorld() || !GetWorld()->GetFirstPlayerController())
+	return -1;
+}
+
+void ACombatManager::CompleteCameraCommand(int32 index, bool success)
+{
+	const ECameraCommandEvent event = CameraCommands[index].OnEnded;
+	CameraCommands.RemoveAt(index, 1, EAllowShrinking::No);
+	OnCameraCommandEnded(event, success);
+}
+
+void ACombatManager::PlaceAnchors()
+{
+	// Clients mirror the server anchors, see OnAnchorReplicated
+	if (HeroAnchorLocations.IsEmpty() || EnemyAnchorLocations.IsEmpty() || !HasAuthority())
 		return;
-	if (auto plController = GetWorld()->GetFirstPlayerController())
+	SyncAnchorComponents(HeroAnchors, HeroAnchorLocations.Num(), TEXT("HeroAnchor"));
+	SyncAnchorComponents(EnemyAnchors, EnemyAnchorLocations.Num(), TEXT("EnemyAnchor"));
+	ReplicatedAnchors.Trim(HeroAnchors.Num(), EnemyAnchors.Num());
+	// Characters are added back on the next query
+	SpatialGrid.Reset(SpatialCellSize);
+	SpatialGridFrame = 0;
+
+	// Any trace still running is for an older placement
+	AnchorSnapGeneration++;
+	PendingAnchorTraces = 0;
+
+	// Snapped with the same transform and settings already, by this combat or a previous one
+	AnchorSnapKey = MakeAnchorSnapKey();
+	UCombatSubSystem* subSys = GetWorld() ? GetWorld()->GetSubsystem<UCombatSubSystem>() : nullptr;
+	if (const TArray<FVector>* cached = subSys ? subSys->FindAnchorSnap(AnchorSnapKey) : nullptr)
 	{
-		if (auto camMgr = plController->PlayerCameraManager)
+		if (cached->Num() == HeroAnchorLocations.Num() + EnemyAnchorLocations.Num())
 		{
-			camMgr->StartCameraFade(fromAlpha, toAlpha, fadeTime, color, true, true);
-			OnCameraFadeEnded = onCameraFadeEnded;
-			FTimerHandle hdl;
-			GetWorld()->GetTimerManager().SetTimer(hdl, [&]()->void {OnCameraFadeCommand_Internal(); }, fadeTime, false);
+			ApplyAnchorLocations(*cached);
+			return;
 		}
 	}
+
+	// Place the anchors unsnapped until the traces come back
+	AnchorSnapResults.Reset(HeroAnchorLocations.Num() + EnemyAnchorLocations.Num());
+	for (const auto& location : HeroAnchorLocations)
+		AnchorSnapResults.Add(GetActorTransform().TransformPosition(location));
+	for (const auto& location : EnemyAnchorLocations)
+		AnchorSnapResults.Add(GetActorTransform().TransformPosition(location));
+	ApplyAnchorLocations(AnchorSnapResults);
+	if (!GetWorld())
+		return;
+
+	// One batch of async traces, resolved with the physics scene instead of stalling this frame
+	FCollisionQueryParams params(SCENE_QUERY_STAT(AnchorSnap), false, this);
+	const FTraceDelegate traceDelegate = FTraceDelegate::CreateUObject(this, &ACombatManager::OnAnchorTraceDone, AnchorSnapGeneration);
+	const FVector snapOffset = GetActorUpVector() * AnchorSnapDistance;
+	for (int32 i = 0; i < AnchorSnapResults.Num(); i++)
+	{
+		GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, AnchorSnapResults[i], AnchorSnapResults[i] - snapOffset, ECC_WorldStatic, params, FCollisionResponseParams::DefaultResponseParam, &traceDelegate, i);
+		PendingAnchorTraces++;
+	}
 }
 
-void ACombatManager::PlaceAnchors()
+void ACombatManager::BuildWorldSpawns()
 {
-	if (HeroAnchorLocations.IsEmpty() || EnemyAnchorLocations.IsEmpty())
-		return;
-	// Spawn Heroes anchors
-	const bool isHeroesSync = HeroAnchors.Num() == HeroAnchorLocations.Num();
-	if (!isHeroesSync)
+	WorldHeroSpawns.Reset(HeroSpawns.Num());
+	for (const auto& spawn : HeroSpawns)
+		WorldHeroSpawns.Add(FTransform(GetActorTransform().TransformRotation(spawn.GetRotation()), GetActorTransform().TransformPosition(spawn.GetLocation()), FVector::OneVector));
+	WorldEnemySpawns.Reset(EnemySpawns.Num());
+	for (const auto& spawn : EnemySpawns)
+		WorldEnemySpawns.Add(FTransform(GetActorTransform().TransformRotation(spawn.GetRotation()), GetActorTransform().TransformPosition(spawn.GetLocation()), FVector::OneVector));
+}
+
+void ACombatManager::SyncAnchorComponents(TArray<TObjectPtr<UCharacterAnchor>>& anchors, int32 count, const TCHAR* prefix)
+{
+	// Keep the anchors already created, only add or remove the difference
+	anchors.RemoveAll([](const TObjectPtr<UCharacterAnchor>& anchor) { return !anchor; });
+	while (anchors.Num() > count)
 	{
-		for (auto anchor : HeroAnchors)
-			if (anchor) anchor->DestroyComponent();
-		HeroAnchors.Empty();
+		if (auto anchor = anchors.Pop())
+			anchor->DestroyComponent();
 	}
-	for (int i = 0; i < HeroAnchorLocations.Num(); i++)
+	for (int32 i = anchors.Num(); i < count; i++)
 	{
-		auto location = GetActorTransform().TransformPosition(HeroAnchorLocations[i]);
-		FHitResult hit;
-		if (GetWorld() && GetWorld()->LineTraceSingleByChannel(hit, location, location - GetActorUpVector() * AnchorSnapDistance, ECC_WorldStatic))
-			location = hit.ImpactPoint + (hit.TraceStart - hit.TraceEnd).GetSafeNormal() * AnchorSnapElevation;
-		if (isHeroesSync)
-		{
-			if (HeroAnchors.IsValidIndex(i) && HeroAnchors[i])
-				HeroAnchors[i]->SetRelativeLocation(GetActorTransform().InverseTransformPosition(location));
-			continue;
-		}
-		auto anchor = NewObject<UCharacterAnchor>(this, FName(FString::Printf(TEXT("HeroAnchor_%d"), i + 1)));
+		const FName anchorName = MakeUniqueObjectName(this, UCharacterAnchor::StaticClass(), FName(FString::Printf(TEXT("%s_%d"), prefix, i + 1)));
+		auto anchor = NewObject<UCharacterAnchor>(this, anchorName);
 		anchor->SetupAttachment(RootComponent);
 		anchor->RegisterComponent();
-		anchor->SetRelativeLocation(GetActorTransform().InverseTransformPosition(location));
-		HeroAnchors.Add(anchor);
+		anchor->OnAnchorStateChanged.AddUniqueDynamic(this, &ACombatManager::OnAnchorStateChanged_Internal);
+		anchors.Add(anchor);
 	}
+}
 
-	// Spawn Enemies anchors
-	const bool isEnemiesSync = EnemyAnchors.Num() == EnemyAnchorLocations.Num();
-	if (!isEnemiesSync)
+void ACombatManager::ApplyAnchorLocations(const TArray<FVector>& worldLocations)
+{
+	const FTransform& transform = GetActorTransform();
+	for (int32 i = 0; i < worldLocations.Num(); i++)
 	{
-		for (auto anchor : EnemyAnchors)
-			if (anchor) anchor->DestroyComponent();
-		EnemyAnchors.Empty();
+		const bool isHero = i < HeroAnchors.Num();
+		UCharacterAnchor* anchor = isHero ? HeroAnchors[i].Get() : (EnemyAnchors.IsValidIndex(i - HeroAnchors.Num()) ? EnemyAnchors[i - HeroAnchors.Num()].Get() : nullptr);
+		if (!anchor)
+			continue;
+		anchor->SetRelativeLocation(transform.InverseTransformPosition(worldLocations[i]));
+		SpatialGrid.Update(anchor, anchor->GetComponentLocation(), isHero ? ECombatSpatialKind::HeroAnchor : ECombatSpatialKind::EnemyAnchor);
+		UpdateReplicatedAnchor(anchor);
 	}
-	for (int i = EnemyAnchorLocations.Num() - 1; i >= 0; i--)
+}
+
+FAnchorSnapKey ACombatManager::MakeAnchorSnapKey() const
+{
+	FAnchorSnapKey key;
+	key.Location = GetActorLocation();
+	key.Rotation = GetActorQuat();
+	key.Scale = GetActorScale3D();
+	key.SnapDistance = AnchorSnapDistance;
+	key.SnapElevation = AnchorSnapElevation;
+	key.HeroAnchorLocations = HeroAnchorLocations;
+	key.EnemyAnchorLocations = EnemyAnchorLocations;
+	key.Hash = GetTypeHash(key.Location);
+	key.Hash = HashCombineFast(key.Hash, GetTypeHash(key.Rotation.Euler()));
+	key.Hash = HashCombineFast(key.Hash, GetTypeHash(key.Scale));
+	key.Hash = HashCombineFast(key.Hash, GetTypeHash(key.SnapDistance));
+	key.Hash = HashCombineFast(key.Hash, GetTypeHash(key.SnapElevation));
+	for (const auto& location : HeroAnchorLocations)
+		key.Hash = HashCombineFast(key.Hash, GetTypeHash(location));
+	key.Hash = HashCombineFast(key.Hash, GetTypeHash(HeroAnchorLocations.Num()));
+	for (const auto& location : EnemyAnchorLocations)
+		key.Hash = HashCombineFast(key.Hash, GetTypeHash(location));
+	return key;
+}
+
+void ACombatManager::OnAnchorTraceDone(const FTraceHandle& handle, FTraceDatum& datum, uint32 generation)
+{
+	if (generation != AnchorSnapGeneration || !AnchorSnapResults.IsValidIndex(datum.UserData))
+		return;
+	for (const FHitResult& hit : datum.OutHits)
 	{
-		auto location = GetActorTransform().TransformPosition(EnemyAnchorLocations[i]);
-		FHitResult hit;
-		if (GetWorld() && GetWorld()->LineTraceSingleByChannel(hit, location, location - GetActorUpVector() * AnchorSnapDistance, ECC_WorldStatic))
-			location = hit.ImpactPoint + (hit.TraceStart - hit.TraceEnd).GetSafeNormal() * AnchorSnapElevation;
-		if (isEnemiesSync)
+		if (hit.bBlockingHit)
 		{
-			if (EnemyAnchors.IsValidIndex(i) && EnemyAnchors[i])
-				EnemyAnchors[i]->SetRelativeLocation(GetActorTransform().InverseTransformPosition(location));
-			continue;
+			AnchorSnapResults[datum.UserData] = hit.ImpactPoint + (datum.Start - datum.End).GetSafeNormal() * AnchorSnapElevation;
+			break;
 		}
-		auto anchor = NewObject<UCharacterAnchor>(this, FName(FString::Printf(TEXT("EnemyAnchor_%d"), i + 1)));
-		anchor->SetupAttachment(RootComponent);
-		anchor->RegisterComponent();
-		anchor->SetRelativeLocation(GetActorTransform().InverseTransformPosition(location));
-		EnemyAnchors.Insert(anchor, 0);
 	}
+	if (--PendingAnchorTraces > 0)
+		return;
+
+	// The whole batch is back
+	ApplyAnchorLocations(AnchorSnapResults);
+	if (auto subSys = GetWorld() ? GetWorld()->GetSubsystem<UCombatSubSystem>() : nullptr)
+		subSys->StoreAnchorSnap(AnchorSnapKey, AnchorSnapResults);
 }
 
 void ACombatManager::InitCombat(UCombatData* data)
 {
-	if (!data)
+	// Spawning is server authoritative
+	if (!data || !HasAuthority())
 		return;
 	if (HeroSpawns.IsEmpty())
 		return;
@@ -370,37 +1095,63 @@ void ACombatManager::InitCombat(UCombatData* data)
 	auto combatId = data->GetPrimaryAssetId();
 	if (!combatId.IsValid())
 		return;
-	if (auto gameInstance = UGameplayStatics::GetGameInstance(GetWorld()))
+	if (auto levelSub = GetStageSubsystem())
 	{
-		if (auto levelSub = gameInstance->GetSubsystem<ULevelSubsystem>())
-		{
-			_wasLastStage = levelSub->IsLastStage();
-		}
+		_wasLastStage = levelSub->IsLastStage();
 	}
 	CombatDataID = combatId;
 	CombatData = data;
+	// Traversals shared with the previous stage keep their grant
+	ReleaseTraversalGrants(true);
 
 	// Place anchors on the ground
 	PlaceAnchors();
 
 	// Clear previous heroes and enemies
-	for (auto hero : HeroesInScene)
+	UCombatSubSystem* subSys = GetWorld() ? GetWorld()->GetSubsystem<UCombatSubSystem>() : nullptr;
+	// Moved out first, destroying them calls back into the OnDestroyed handlers
+	const auto lastHeroes = MoveTemp(HeroesInScene);
+	HeroesInScene.Reset();
+	for (auto hero : lastHeroes)
+	{
+		if (subSys) subSys->UnregisterCombatActor(hero);
 		if (hero) hero->Destroy();
-	HeroesInScene.Empty();
-	for (auto enemy : EnemiesInScene)
+	}
+	const auto lastEnemies = MoveTemp(EnemiesInScene);
+	EnemiesInScene.Reset();
+	for (auto enemy : lastEnemies)
+	{
+		if (subSys) subSys->UnregisterCombatActor(enemy);
 		if (enemy) enemy->Destroy();
-	EnemiesInScene.Empty();
+	}
+	ReplicatedEnemies.Items.Reset();
+	ReplicatedEnemies.MarkArrayDirty();
 
-	//Set state to Opening
+	//Set state to Opening. The phase work is applied even when Opening is the default phase
 	SetCombatPhase(ECombatPhase::Opening);
+	ApplyPhaseSchedule(CurrentPhase);
+
+	//Start at the beginning of the Combat data waves, scaled with the current difficulty
+	const auto levelSubsystem = GetGameInstance() ? GetGameInstance()->GetSubsystem<ULevelSubsystem>() : nullptr;
+	CombatDifficulty.Difficulty = levelSubsystem ? levelSubsystem->GetDifficulty() : FCombatDifficulty();
+	CombatDifficulty.StageIndex = levelSubsystem ? levelSubsystem->StageIndex() : 0;
+	BuildWaveSchedule();
+	WaveCursor.Reset();
+	SyncEnemyProxies();
+	InFlightSpawns = 0;
+	SpawnReservedAnchors.Reset();
+	HeldEnemySpawns.Reset();
+	Telemetry.Reset();
+	UpdateReplicatedCursor();
 
-	//Enqueue Enemy Waves from Combat data
-	WaveQueue.Empty();
-	for (auto wave : CombatData->EnemyWaves)
-		WaveQueue.Enqueue(wave);
+	//Spawn points in world space, and their selection state
+	BuildWorldSpawns();
+	EnemySpawnLastUse.Init(INDEX_NONE, WorldEnemySpawns.Num());
+	EnemySpawnCount = 0;
+	SpawnStream.Initialize(SpawnSeed != 0 ? SpawnSeed : static_cast<int32>(GetTypeHash(CombatDataID)));
 
 	//Spawn Player hero
-	FTransform heroSpawn = FTransform(GetActorTransform().TransformRotation(HeroSpawns[0].GetRotation()), GetActorTransform().TransformPosition(HeroSpawns[0].GetLocation()), FVector::OneVector);
+	const FTransform& heroSpawn = WorldHeroSpawns[0];
 	mgr->LoadPrimaryAsset(TestPlayerData, { BUNDLE_SPAWN }, FStreamableDelegate::CreateUObject(this, &ACombatManager::OnHeroPlayerLoaded_Internal, TestPlayerData, heroSpawn, HeroAnchors.IsValidIndex(0) ? HeroAnchors[0].Get() : nullptr));
 }
 
@@ -409,9 +1160,9 @@ void ACombatManager::SpawnAllies()
 	auto mgr = UAssetManager::GetIfInitialized();
 	if (!mgr)
 		return;
-	if (HeroSpawns.IsValidIndex(1) && TestPlayerCombiData.IsValid())
+	if (WorldHeroSpawns.IsValidIndex(1) && TestPlayerCombiData.IsValid())
 	{
-		FTransform heroCombiSpawn = FTransform(GetActorTransform().TransformRotation(HeroSpawns[1].GetRotation()), GetActorTransform().TransformPosition(HeroSpawns[1].GetLocation()), FVector::OneVector);
+		const FTransform& heroCombiSpawn = WorldHeroSpawns[1];
 		mgr->LoadPrimaryAsset(TestPlayerCombiData, { BUNDLE_SPAWN }, FStreamableDelegate::CreateUObject(this, &ACombatManager::OnHeroLoaded_Internal, TestPlayerCombiData, heroCombiSpawn, HeroAnchors.IsValidIndex(1) ? HeroAnchors[1].Get() : nullptr));
 	}
 }
@@ -420,17 +1171,7 @@ void ACombatManager::BeginCombat()
 {
 	// Pan the camera to the combat area
 	SetCombatPhase(ECombatPhase::Begining);
-	MoveCameraCommand(this, CameraBlendTime, [&](bool success)
-					  {
-						  if (success)
-						  {
-							  if (CurrentPhase == ECombatPhase::Begining)
-							  {
-								  OnPhaseEnded.Broadcast(ECombatPhase::Begining);
-							  }
-							  SetCombatPhase(ECombatPhase::Active);
-						  }
-					  });
+	MoveCameraCommand(this, CameraBlendTime, ECameraCommandEvent::BeginingCameraReady);
 
 	// Wait for the camera to be ready
 	// Set the combat phase to Active
@@ -438,189 +1179,197 @@ void ACombatManager::BeginCombat()
 
 void ACombatManager::EndCombat()
 {
-	UKismetSystemLibrary::PrintString(this, FString::Printf(TEXT("Combat Ended")));
+	UE_LOG(LogCombat, Log, TEXT("%s: Combat Ended"), *GetName());
 	SetCombatPhase(ECombatPhase::Ended);
 	// Fade in the black screen
-	FadeCameraCommand(0.f, 1.f, CameraFadeTime, FLinearColor::Black, [&](bool success) { OnPhaseEnded.Broadcast(ECombatPhase::Ended); });
+	FadeCameraCommand(0.f, 1.f, CameraFadeTime, FLinearColor::Black, ECameraCommandEvent::EndedFadeCompleted);
 }
 
 void ACombatManager::CreateNextWave()
 {
-	// Set the current wave
-	if (WaveQueue.Dequeue(CurrentWave))
+	if (!HasAuthority())
+		return;
+	// Set the current wave. Waves without enemies are already stripped from the schedule
+	if (WaveSchedule && WaveCursor.NextWave(*WaveSchedule))
 	{
-		UKismetSystemLibrary::PrintString(this, FString::Printf(TEXT("Switch to new Wave with %d enemies. Is last wave? %d"), CurrentWave.WaveEnemies.Num(), WaveQueue.IsEmpty()));
-
-		//Set the current wave to the first enemy in the queue
-		if (CurrentWave.WaveEnemies.IsEmpty())
-		{
-			CreateNextWave(); //No enemies in this wave, try next one
-			return;
-		}
-
-		//Set the spawn queue to the current wave enemies
-		for (const auto& enemy : CurrentWave.WaveEnemies)
-		{
-			if (enemy.IsValid())
-				SpawnQueue.Enqueue(enemy);
-		}
-
-		if (SpawnQueue.IsEmpty())
-		{
-			//No enemies to spawn, try next wave
-			CreateNextWave();
-			return;
-		}
+		const FCompiledWave& wave = WaveSchedule->Waves[WaveCursor.WaveIndex];
+		UpdateReplicatedCursor();
+		Telemetry.BeginWave(FPlatformTime::Seconds());
+		TRACE_BOOKMARK(TEXT("%s: Wave %d"), *GetName(), WaveCursor.WaveIndex);
+		// Proxies show up once the wave enemies are loaded
+		PrefetchUpcomingWaves();
+		SyncEnemyProxies();
+		UE_LOG(LogCombat, Log, TEXT("%s: Switch to new Wave with %d enemies. Is last wave? %d"), *GetName(), wave.EnemyCount, WaveCursor.IsLastWave(*WaveSchedule));
 
 		//Start the spawn timer
-		if (CurrentWave.SpawnDelay > 0.f)
-			SpawnTimer = CurrentWave.SpawnDelay;
+		if (wave.SpawnDelay > 0.f)
+			SpawnTimer = wave.SpawnDelay;
+		ScheduleSpawn();
 	}
 	else if (CurrentPhase == ECombatPhase::Active)
 	{
-		int aliveCount = 0;
-		for (auto enemy : EnemiesInScene)
-		{
-			if (enemy && enemy->IsCharacterAlive())
-				aliveCount++;
-		}
-		UKismetSystemLibrary::PrintString(this, FString::Printf(TEXT("No More Waves: %d still alives"), aliveCount));
+		const int32 aliveCount = CountAliveEnemies();
+		UE_LOG(LogCombat, Verbose, TEXT("%s: No More Waves: %d still alives"), *GetName(), aliveCount);
 		if (aliveCount > 0)
 			return; //No more waves to create, but enemies are still alive
 
 		// No more waves to create, end the combat
+		Telemetry.EndWave(FPlatformTime::Seconds());
 		SetCombatPhase(ECombatPhase::Ending);
 
 		if (HeroesInScene.IsValidIndex(0))
 		{
 			if (auto heroActor = HeroesInScene[0])
 			{
-				if (auto gameInstance = UGameplayStatics::GetGameInstance(GetWorld()))
+				if (auto levelSub = GetStageSubsystem())
 				{
-					if (auto levelSub = gameInstance->GetSubsystem<ULevelSubsystem>())
-					{
-						if (!_wasLastStage)
-							levelSub->MoveToStage(1);
-					}
+					if (!_wasLastStage)
+						levelSub->MoveToStage(1);
 				}
 
 				//Make the player do the outro traversal
 				bool madeTraversalOutro = false;
-				if (CombatData && !_wasLastStage)
-				{
-					auto traversal = CombatData->PlayerOutroTraversal.Get();
-					//Load the traversal if not already loaded
-					if (!traversal)
-						traversal = CombatData->PlayerOutroTraversal.LoadSynchronous();
-					//Set the traversal to the Hero
-					if (traversal)
-					{
-						if (auto abilitySystem = heroActor->GetAbilitySystemComponent())
-						{
-							//Give the traversal ability to the Hero
-							auto spec = FGameplayAbilitySpec(traversal, 1, -1, heroActor);
-							auto handle = abilitySystem->GiveAbilityAndActivateOnce(spec);
-							madeTraversalOutro = handle.IsValid();
-						}
-					}
-				}
+				if (CombatData && !_wasLastStage && !bHeadless)
+					madeTraversalOutro = ActivateTraversal(heroActor, CombatData->PlayerOutroTraversal);
 
 				//Snap to the Player's Camera
-				MoveCameraCommand(heroActor, CameraBlendTime, [&, madeTraversalOutro](bool success)
-								  {
-									  OnPhaseEnded.Broadcast(ECombatPhase::Ending);
-									  if (!madeTraversalOutro)
-									  {
-										  //If the outro traversal is not set, just execute end combat
-										  EndCombat();
-									  }
-								  });
-
+				bMadeTraversalOutro = madeTraversalOutro;
+				MoveCameraCommand(heroActor, CameraBlendTime, ECameraCommandEvent::EndingCameraReady);
 			}
 		}
 	}
 }
 
-bool ACombatManager::TrySpawnEnemy(float DeltaTime)
+bool ACombatManager::TrySpawnEnemy()
 {
-	if (CurrentWave.SpawnMode == EWaveSpawnMode::None || bIsSpawning)
+	SCOPE_CYCLE_COUNTER(STAT_CombatTrySpawn);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(ACombatManager_TrySpawnEnemy, CombatChannel);
+	const FCompiledWave* wave = WaveSchedule ? WaveCursor.GetWave(*WaveSchedule) : nullptr;
+	if (!FCombatRules::CanStartSpawn(wave, InFlightSpawns) || !HasAuthority())
 		return false;
-	if (SpawnTimer > 0)
+	bool hasSpawned = false;
+	TArray<FCombatAnchorSlot, TInlineAllocator<32>> slots;
+	TArray<UCharacterAnchor*, TInlineAllocator<32>> anchors;
+	for (int32 burst = 0; burst < wave->SpawnBurst; burst++)
 	{
-		SpawnTimer -= DeltaTime;
-		if (SpawnTimer > 0)
-			return false; //Cannot spawn if a timer is active
-		else
+		GatherAnchorSlots(slots, anchors);
+		UE_LOG(LogCombat, VeryVerbose, TEXT("%s: Try to Spwn Enemy -> in scene: %d. Alives: %d. Free Anchors: %d. Loading: %d"), *GetName(), EnemiesInScene.Num(), CountAliveEnemies(), FCombatRules::CountFreeAnchors(slots), InFlightSpawns);
+
+		// Get the next enemy to spawn
+		FPrimaryAssetId enemyID;
+		const ECombatSpawnStep step = FCombatRules::PopNextSpawn(*WaveSchedule, WaveCursor, slots, InFlightSpawns, enemyID);
+		if (step == ECombatSpawnStep::Blocked)
+			break; //Cannot spawn if there are not enough anchors are free
+		if (step == ECombatSpawnStep::WaveDone)
 		{
-			//if (CurrentWave.SpawnDelay > 0)
-			//	SpawnTimer = CurrentWave.SpawnDelay;
+			CreateNextWave(); //No enemies to spawn, try next wave
+			break;
 		}
+
+		// Spawn the enemy at a spawn point, its proxy is only visual and gets dropped by the sync below
+		SpawnEnemy(enemyID);
+		hasSpawned = true;
 	}
-	int existingEnemies = EnemiesInScene.Num();
-	int aliveCount = 0;
-	for (auto enemy : EnemiesInScene)
-	{
-		if (enemy && enemy->IsCharacterAlive())
-			aliveCount++;
-	}
-	int freeAnchorCount = 0;
-	for (auto anchor : EnemyAnchors)
-	{
-		if (anchor && anchor->GetAnchorState() == EAnchorState::Free)
-			freeAnchorCount++;
-	}
-	UKismetSystemLibrary::PrintString(this, FString::Printf(TEXT("Try to Spwn Enemy -> in scene: %d. Alives: %d. Free Anchors: %d"), existingEnemies, aliveCount, freeAnchorCount));
-	switch (CurrentWave.SpawnMode)
+	if (hasSpawned)
 	{
-		case EWaveSpawnMode::OnAllAnchorsFree:
-			if (freeAnchorCount < 3 && !CurrentWave.HasBeganSpawn)
-				return false; //Cannot spawn if there are no free anchors
-			break;
-		case EWaveSpawnMode::OnTwoAnchorsFree:
-			if (freeAnchorCount < 2 && !CurrentWave.HasBeganSpawn)
-				return false; //Cannot spawn if there are not enough anchors are free
-			break;
-		case EWaveSpawnMode::OnOneAnchorsFree:
-			if (freeAnchorCount < 1)
-				return false; //Cannot spawn if there are not enough anchors are free
-			break;
+		UpdateReplicatedCursor();
+		SyncEnemyProxies();
 	}
+	return hasSpawned;
+}
 
-	// Get the next enemy to spawn
-	FPrimaryAssetId enemyID;
-	if (!SpawnQueue.Dequeue(enemyID))
-	{
-		CreateNextWave(); //No enemies to spawn, try next wave
-		return false;
-	}
+UCharacterAnchor* ACombatManager::FindSpawnAnchor() const
+{
+	TArray<FCombatAnchorSlot, TInlineAllocator<32>> slots;
+	TArray<UCharacterAnchor*, TInlineAllocator<32>> anchors;
+	GatherAnchorSlots(slots, anchors);
+	const int32 index = FCombatRules::FindSpawnAnchor(slots);
+	return anchors.IsValidIndex(index) ? anchors[index] : nullptr;
+}
 
-	// Check if the enemy ID is valid
-	if (!enemyID.IsValid())
+void ACombatManager::GatherAnchorSlots(TArray<FCombatAnchorSlot, TInlineAllocator<32>>& outSlots, TArray<UCharacterAnchor*, TInlineAllocator<32>>& outAnchors) const
+{
+	outSlots.Reset();
+	outAnchors.Reset();
+	for (UCharacterAnchor* anchor : EnemyAnchors)
 	{
-		//Invalid enemy ID, try next enemy
-		return false;
+		if (!anchor)
+			continue;
+		FCombatAnchorSlot& slot = outSlots.AddDefaulted_GetRef();
+		slot.Location = anchor->GetComponentLocation();
+		if (auto owner = anchor->GetBaseOwnwer())
+		{
+			slot.bHasOwner = true;
+			slot.OwnerLocation = owner->GetActorLocation();
+		}
+		slot.bSpawnReserved = SpawnReservedAnchors.Contains(anchor);
+		outAnchors.Add(anchor);
 	}
-
-	// Spawn the enemy
-	CurrentWave.HasBeganSpawn = true;
-	SpawnEnemy(enemyID);
-	return true;
 }
 
 void ACombatManager::SpawnEnemy(FPrimaryAssetId enemyID)
 {
-	if (EnemySpawns.IsEmpty())
+	if (WorldEnemySpawns.IsEmpty() || !HasAuthority())
 		return;
-	UKismetSystemLibrary::PrintString(this, FString::Printf(TEXT("Spawning Enemy -> ID: %s"), *enemyID.PrimaryAssetName.ToString()));
-	auto spawnLocation = GetActorTransform().TransformPosition(EnemySpawns[(int)(FMath::RandRange(0, EnemySpawns.Num() - 1))].GetLocation());
-	auto spawnRotation = GetActorTransform().TransformRotation(EnemySpawns[(int)(FMath::RandRange(0, EnemySpawns.Num() - 1))].GetRotation());
+	UE_LOG(LogCombat, Verbose, TEXT("%s: Spawning Enemy -> ID: %s"), *GetName(), *enemyID.ToString());
 	auto mgr = UAssetManager::GetIfInitialized();
 	if (!mgr)
 		return;
-	if (enemyID.IsValid())
+	UCharacterAnchor* spawnAnchor = FindSpawnAnchor();
+	if (enemyID.IsValid() && spawnAnchor)
 	{
-		bIsSpawning = true;
-		FTransform heroCombiSpawn = FTransform(spawnRotation, spawnLocation, FVector::OneVector);
-		mgr->LoadPrimaryAsset(enemyID, { BUNDLE_SPAWN }, FStreamableDelegate::CreateUObject(this, &ACombatManager::OnEnemyLoaded_Internal, enemyID, heroCombiSpawn, EnemyAnchors.Last().Get()));
+		InFlightSpawns++;
+		SpawnReservedAnchors.Add(spawnAnchor);
+		const FTransform& enemySpawn = WorldEnemySpawns[SelectEnemySpawnPoint()];
+		mgr->LoadPrimaryAsset(enemyID, { BUNDLE_SPAWN }, FStreamableDelegate::CreateUObject(this, &ACombatManager::OnEnemyLoaded_Internal, enemyID, enemySpawn, spawnAnchor, FPlatformTime::Seconds()));
+	}
+}
+
+int32 ACombatManager::SelectEnemySpawnPoint()
+{
+	int32 selected = 0;
+	switch (SpawnPointStrategy)
+	{
+		case ESpawnPointStrategy::Random:
+			selected = SpawnStream.RandRange(0, WorldEnemySpawns.Num() - 1);
+			break;
+		case ESpawnPointStrategy::RoundRobin:
+			selected = EnemySpawnCount % WorldEnemySpawns.Num();
+			break;
+		case ESpawnPointStrategy::FarthestFromHeroes:
+			{
+				float farthest = -1;
+				for (int32 i = 0; i < WorldEnemySpawns.Num(); i++)
+				{
+					// Distance to the closest hero
+					float closest = UE_MAX_FLT;
+					for (const auto& hero : HeroesInScene)
+					{
+						if (hero)
+							closest = FMath::Min(closest, FVector::DistSquared(hero->GetActorLocation(), WorldEnemySpawns[i].GetLocation()));
+					}
+					if (closest > farthest)
+					{
+						farthest = closest;
+						selected = i;
+					}
+				}
+			}
+			break;
+		case ESpawnPointStrategy::LeastRecentlyUsed:
+			{
+				// Never used points first, ties broken by the random stream
+				const int32 offset = SpawnStream.RandRange(0, WorldEnemySpawns.Num() - 1);
+				selected = offset;
+				for (int32 n = 1; n < WorldEnemySpawns.Num(); n++)
+				{
+					const int32 i = (offset + n) % WorldEnemySpawns.Num();
+					if (EnemySpawnLastUse[i] < EnemySpawnLastUse[selected])
+						selected = i;
+				}
+			}
+			break;
 	}
+	EnemySpawnLastUse[selected] = EnemySpawnCount++;
+	return selected;
 }
@@ -0,0 +1,92 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+
+#include "Combat/AnchorFormationSolver.h"
+
+
+bool FAnchorFormationSolver::Solve(TConstArrayView<FVector> characters, TConstArrayView<FVector> anchors, TArray<int32>& outAssignment)
+{
+	const int32 rows = characters.Num();
+	const int32 columns = anchors.Num();
+	outAssignment.Reset();
+	if (rows > columns)
+		return false;
+	if (rows == 0)
+		return true;
+
+	Costs.SetNumUninitialized(rows * columns, EAllowShrinking::No);
+	for (int32 r = 0; r < rows; r++)
+		for (int32 c = 0; c < columns; c++)
+			Costs[r * columns + c] = FVector::Dist(characters[r], anchors[c]);
+
+	RowPotentials.Init(0, rows + 1);
+	ColumnPotentials.Init(0, columns + 1);
+	ColumnMatch.Init(0, columns + 1);
+	ColumnWay.Init(0, columns + 1);
+	MinSlack.SetNumUninitialized(columns + 1, EAllowShrinking::No);
+	ColumnUsed.SetNumUninitialized(columns + 1, EAllowShrinking::No);
+
+	// Add the rows one by one, growing an alternating path of minimal reduced cost until a free column is met
+	for (int32 r = 1; r <= rows; r++)
+	{
+		ColumnMatch[0] = r;
+		int32 column = 0;
+		for (int32 c = 0; c <= columns; c++)
+		{
+			MinSlack[c] = TNumericLimits<double>::Max();
+			ColumnUsed[c] = false;
+		}
+		do
+		{
+			ColumnUsed[column] = true;
+			const int32 row = ColumnMatch[column];
+			double delta = TNumericLimits<double>::Max();
+			int32 nextColumn = 0;
+			for (int32 c = 1; c <= columns; c++)
+			{
+				if (ColumnUsed[c])
+					continue;
+				const double slack = Costs[(row - 1) * columns + (c - 1)] - RowPotentials[row] - ColumnPotentials[c];
+				if (slack < MinSlack[c])
+				{
+					MinSlack[c] = slack;
+					ColumnWay[c] = column;
+				}
+				if (MinSlack[c] < delta)
+				{
+					delta = MinSlack[c];
+					nextColumn = c;
+				}
+			}
+			for (int32 c = 0; c <= columns; c++)
+			{
+				if (ColumnUsed[c])
+				{
+					RowPotentials[ColumnMatch[c]] += delta;
+					ColumnPotentials[c] -= delta;
+				}
+				else
+				{
+					MinSlack[c] -= delta;
+				}
+			}
+			column = nextColumn;
+		} while (ColumnMatch[column] != 0);
+
+		// Flip the path
+		do
+		{
+			const int32 previous = ColumnWay[column];
+			ColumnMatch[column] = ColumnMatch[previous];
+			column = previous;
+		} while (column != 0);
+	}
+
+	outAssignment.Init(INDEX_NONE, rows);
+	for (int32 c = 1; c <= columns; c++)
+	{
+		if (ColumnMatch[c] != 0)
+			outAssignment[ColumnMatch[c] - 1] = c - 1;
+	}
+	return true;
+}
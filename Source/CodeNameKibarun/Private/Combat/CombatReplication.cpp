@@ -0,0 +1,143 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+
+#include "Combat/CombatReplication.h"
+#include "Actors/CombatManager.h"
+#include "SubSystems/CombatSubSystem.h"
+#include "CodeNameKibarun.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+
+void FReplicatedAnchor::PostReplicatedAdd(const FReplicatedAnchorArray& InArraySerializer)
+{
+	if (auto manager = InArraySerializer.Manager.Get())
+		manager->OnAnchorReplicated(*this);
+}
+
+void FReplicatedAnchor::PostReplicatedChange(const FReplicatedAnchorArray& InArraySerializer)
+{
+	if (auto manager = InArraySerializer.Manager.Get())
+		manager->OnAnchorReplicated(*this);
+}
+
+void FReplicatedAnchorArray::SetAnchor(int32 index, bool isEnemy, const UCharacterAnchor* anchor)
+{
+	if (!anchor)
+		return;
+	// Never narrow silently, a wrapped index would overwrite another anchor on the clients
+	if (!ensureMsgf(index >= 0 && index <= MAX_uint16, TEXT("Anchor index %d can't be replicated"), index))
+		return;
+	FReplicatedAnchor* item = Items.FindByPredicate([index, isEnemy](const FReplicatedAnchor& entry) { return entry.Index == index && entry.bIsEnemy == isEnemy; });
+	if (!item)
+	{
+		item = &Items.AddDefaulted_GetRef();
+		item->Index = static_cast<uint16>(index);
+		item->bIsEnemy = isEnemy;
+	}
+	const FVector location = anchor->GetComponentLocation();
+	ABaseGasCharacter* owner = const_cast<UCharacterAnchor*>(anchor)->GetBaseOwnwer();
+	// Quantized to a tenth of unit, smaller moves are not worth sending
+	if (item->ReplicationID != INDEX_NONE && item->State == anchor->GetAnchorState() && item->Owner == owner && item->Location.Equals(location, 0.1))
+		return;
+	item->State = anchor->GetAnchorState();
+	item->Owner = owner;
+	item->Location = location;
+	MarkItemDirty(*item);
+}
+
+void FReplicatedAnchorArray::Trim(int32 heroCount, int32 enemyCount)
+{
+	const int32 removed = Items.RemoveAll([heroCount, enemyCount](const FReplicatedAnchor& entry) { return entry.Index >= (entry.bIsEnemy ? enemyCount : heroCount); });
+	if (removed > 0)
+		MarkArrayDirty();
+}
+
+const FReplicatedAnchor* FReplicatedAnchorArray::Find(int32 index, bool isEnemy) const
+{
+	return Items.FindByPredicate([index, isEnemy](const FReplicatedAnchor& entry) { return entry.Index == index && entry.bIsEnemy == isEnemy; });
+}
+
+bool FReplicatedAnchorArray::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	const int64 bitsBefore = DeltaParms.Writer ? DeltaParms.Writer->GetNumBits() : 0;
+	const bool result = FFastArraySerializer::FastArrayDeltaSerialize<FReplicatedAnchor, FReplicatedAnchorArray>(Items, DeltaParms, *this);
+	if (DeltaParms.Writer && Manager.IsValid())
+		Manager->GetNetStats().BitsWritten += DeltaParms.Writer->GetNumBits() - bitsBefore;
+	return result;
+}
+
+void FReplicatedEnemyRoster::AddEnemy(ABaseGasCharacter* character, const FPrimaryAssetId& enemyID, uint16 wave)
+{
+	if (!character)
+		return;
+	FReplicatedEnemy& item = Items.AddDefaulted_GetRef();
+	item.Character = character;
+	item.EnemyID = enemyID;
+	item.Wave = wave;
+	MarkItemDirty(item);
+}
+
+void FReplicatedEnemyRoster::RemoveEnemy(const AActor* character)
+{
+	const int32 removed = Items.RemoveAll([character](const FReplicatedEnemy& entry) { return entry.Character == character || !entry.Character; });
+	if (removed > 0)
+		MarkArrayDirty();
+}
+
+bool FReplicatedEnemyRoster::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	const int64 bitsBefore = DeltaParms.Writer ? DeltaParms.Writer->GetNumBits() : 0;
+	const bool result = FFastArraySerializer::FastArrayDeltaSerialize<FReplicatedEnemy, FReplicatedEnemyRoster>(Items, DeltaParms, *this);
+	if (DeltaParms.Writer && Manager.IsValid())
+		Manager->GetNetStats().BitsWritten += DeltaParms.Writer->GetNumBits() - bitsBefore;
+	return result;
+}
+
+bool FReplicatedCombatCursor::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	// Phase on 3 bits, spawn flag on 1, wave on 12 and enemy on 16. Small cursors fit in a byte or two
+	uint32 packed = 0;
+	if (Ar.IsSaving())
+		packed = (Phase & 0x7) | (bHasBeganSpawn ? 1u << 3 : 0u) | ((WaveIndex & 0xFFFu) << 4) | (static_cast<uint32>(EnemyIndex) << 16);
+	Ar.SerializeIntPacked(packed);
+	if (Ar.IsLoading())
+	{
+		Phase = packed & 0x7;
+		bHasBeganSpawn = (packed >> 3) & 1;
+		WaveIndex = (packed >> 4) & 0xFFF;
+		EnemyIndex = packed >> 16;
+	}
+	else if (Manager.IsValid())
+	{
+		Manager->GetNetStats().BitsWritten += 8 * (FMath::FloorLog2(packed | 1) / 7 + 1);
+	}
+	bOutSuccess = true;
+	return true;
+}
+
+
+// Print the replicated bytes per second of each combat since the last call
+static FAutoConsoleCommandWithWorldAndArgs GCombatNetStatsCommand(
+	TEXT("Kibarun.Combat.NetStats"),
+	TEXT("Log the bytes/sec written by the replicated state of each combat, in every world, then reset the counters."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (!GEngine)
+			return;
+		for (const FWorldContext& context : GEngine->GetWorldContexts())
+		{
+			UWorld* world = context.World();
+			auto subSys = world ? world->GetSubsystem<UCombatSubSystem>() : nullptr;
+			if (!subSys || world->GetNetMode() == NM_Client)
+				continue;
+			const double time = world->GetTimeSeconds();
+			for (auto combat : subSys->GetCombatManagers())
+			{
+				if (!combat)
+					continue;
+				UE_LOG(LogCombat, Display, TEXT("%s (%s): %.1f bytes/sec"), *combat->GetName(), *world->GetName(), combat->GetNetStats().GetBytesPerSecond(time));
+				combat->GetNetStats().Reset(time);
+			}
+		}
+	}));
@@ -0,0 +1,87 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+
+#include "Combat/CombatRules.h"
+#include "Actors/CombatManager.h"
+
+
+bool FCombatRules::SpawnsDuring(ECombatPhase phase)
+{
+	return phase == ECombatPhase::Active || phase == ECombatPhase::Opening;
+}
+
+int32 FCombatRules::FindSpawnAnchor(TConstArrayView<FCombatAnchorSlot> anchors)
+{
+	for (int32 i = anchors.Num() - 1; i >= 0; i--)
+	{
+		if (anchors[i].IsFree())
+			return i;
+	}
+	return INDEX_NONE;
+}
+
+int32 FCombatRules::CountFreeAnchors(TConstArrayView<FCombatAnchorSlot> anchors)
+{
+	int32 freeAnchorCount = 0;
+	for (const auto& anchor : anchors)
+	{
+		if (anchor.IsFree())
+			freeAnchorCount++;
+	}
+	return freeAnchorCount;
+}
+
+bool FCombatRules::CanStartSpawn(const FCompiledWave* wave, int32 inFlightSpawns)
+{
+	return wave && wave->SpawnMode != EWaveSpawnMode::None && inFlightSpawns < wave->MaxInFlightSpawns;
+}
+
+ECombatSpawnStep FCombatRules::PopNextSpawn(const FCompiledWaveSchedule& schedule, FWaveCursor& cursor, TConstArrayView<FCombatAnchorSlot> anchors, int32 inFlightSpawns, FPrimaryAssetId& outEnemyID)
+{
+	const FCompiledWave* wave = cursor.GetWave(schedule);
+	if (!CanStartSpawn(wave, inFlightSpawns))
+		return ECombatSpawnStep::Blocked;
+	// Cannot spawn if there are not enough anchors free
+	if (!wave->CanSpawn(CountFreeAnchors(anchors), anchors.Num(), cursor.bHasBeganSpawn))
+		return ECombatSpawnStep::Blocked;
+	if (!cursor.PopEnemy(schedule, outEnemyID))
+		return ECombatSpawnStep::WaveDone;
+	cursor.bHasBeganSpawn = true;
+	return ECombatSpawnStep::Spawn;
+}
+
+bool FCombatRules::SolveFormation(TConstArrayView<FCombatAnchorSlot> anchors, TArray<TPair<int32, int32>>& outMoves)
+{
+	outMoves.Reset();
+
+	// The owners fill as many anchors, front-most first. Anchors kept for loading enemies are not given away
+	OwnedAnchors.Reset();
+	OwnerLocations.Reset();
+	for (int32 i = 0; i < anchors.Num(); i++)
+	{
+		if (anchors[i].bHasOwner)
+		{
+			OwnedAnchors.Add(i);
+			OwnerLocations.Add(anchors[i].OwnerLocation);
+		}
+	}
+	TargetAnchors.Reset();
+	TargetLocations.Reset();
+	for (int32 i = 0; i < anchors.Num() && TargetAnchors.Num() < OwnedAnchors.Num(); i++)
+	{
+		if (anchors[i].bSpawnReserved)
+			continue;
+		TargetAnchors.Add(i);
+		TargetLocations.Add(anchors[i].Location);
+	}
+
+	if (!Solver.Solve(OwnerLocations, TargetLocations, Assignment))
+		return false;
+	for (int32 i = 0; i < OwnedAnchors.Num(); i++)
+	{
+		const int32 target = TargetAnchors[Assignment[i]];
+		if (target != OwnedAnchors[i])
+			outMoves.Emplace(OwnedAnchors[i], target);
+	}
+	return true;
+}
@@ -0,0 +1,230 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+
+#include "Combat/CombatSpatialGrid.h"
+
+
+FCombatSpatialGrid::FCombatSpatialGrid(float cellSize)
+{
+	Reset(cellSize);
+}
+
+void FCombatSpatialGrid::Reset(float cellSize)
+{
+	CellSize = FMath::Max(cellSize, 1.f);
+	Entries.Empty();
+	EntryIndices.Empty();
+	Cells.Empty();
+}
+
+void FCombatSpatialGrid::Update(UObject* object, const FVector& location, ECombatSpatialKind kind)
+{
+	if (!object)
+		return;
+	const FIntPoint cell = GetCell(location);
+	if (const int32* existing = EntryIndices.Find(object))
+	{
+		FCombatSpatialEntry& entry = Entries[*existing];
+		entry.Location = location;
+		entry.Kind = kind;
+		if (entry.Cell == cell)
+			return;
+		if (TArray<int32>* oldCell = Cells.Find(entry.Cell))
+		{
+			oldCell->RemoveSingleSwap(*existing, EAllowShrinking::No);
+			if (oldCell->IsEmpty())
+				Cells.Remove(entry.Cell);
+		}
+		entry.Cell = cell;
+		Cells.FindOrAdd(cell).Add(*existing);
+		return;
+	}
+
+	FCombatSpatialEntry entry;
+	entry.Object = object;
+	entry.Location = location;
+	entry.Cell = cell;
+	entry.Kind = kind;
+	const int32 index = Entries.Add(entry);
+	EntryIndices.Add(object, index);
+	Cells.FindOrAdd(cell).Add(index);
+}
+
+void FCombatSpatialGrid::Remove(const UObject* object)
+{
+	int32 index = INDEX_NONE;
+	if (!EntryIndices.RemoveAndCopyValue(object, index))
+		return;
+	const FIntPoint cell = Entries[index].Cell;
+	if (TArray<int32>* bucket = Cells.Find(cell))
+	{
+		bucket->RemoveSingleSwap(index, EAllowShrinking::No);
+		if (bucket->IsEmpty())
+			Cells.Remove(cell);
+	}
+	Entries.RemoveAt(index);
+}
+
+void FCombatSpatialGrid::RemoveStale()
+{
+	for (auto it = EntryIndices.CreateIterator(); it; ++it)
+	{
+		const int32 index = it.Value();
+		if (Entries[index].Object.IsValid())
+			continue;
+		if (TArray<int32>* bucket = Cells.Find(Entries[index].Cell))
+		{
+			bucket->RemoveSingleSwap(index, EAllowShrinking::No);
+			if (bucket->IsEmpty())
+				Cells.Remove(Entries[index].Cell);
+		}
+		Entries.RemoveAt(index);
+		it.RemoveCurrent();
+	}
+}
+
+void FCombatSpatialGrid::QueryRadius(const FVector& center, float radius, ECombatSpatialKind kinds, TArray<UObject*>& outResults) const
+{
+	outResults.Reset();
+	const FVector extent(radius, radius, 0);
+	const float radiusSq = radius * radius;
+	ForEachInBox(center - extent, center + extent, kinds, [&](const FCombatSpatialEntry& entry)
+	{
+		if (FVector::DistSquared2D(entry.Location, center) <= radiusSq)
+			outResults.Add(entry.Object.Get());
+	});
+}
+
+void FCombatSpatialGrid::QueryNearest(const FVector& center, int32 count, ECombatSpatialKind kinds, TArray<UObject*>& outResults, float maxRadius) const
+{
+	outResults.Reset();
+	if (count <= 0 || Entries.Num() <= 0)
+		return;
+
+	TArray<TPair<float, UObject*>, TInlineAllocator<16>> candidates;
+	const float maxRadiusSq = maxRadius * maxRadius;
+	auto gather = [&](const FCombatSpatialEntry& entry)
+	{
+		const float distSq = FVector::DistSquared2D(entry.Location, center);
+		if (distSq <= maxRadiusSq)
+			candidates.Emplace(distSq, entry.Object.Get());
+	};
+	auto byDistance = [](const TPair<float, UObject*>& a, const TPair<float, UObject*>& b) { return a.Key < b.Key; };
+
+	// Grow the searched square ring by ring until the k-th candidate is closer than any unvisited cell.
+	// Past a few rings the arena is sparse enough that a flat scan is cheaper.
+	constexpr int32 MaxRings = 16;
+	const FIntPoint origin = GetCell(center);
+	const int32 ringLimit = FMath::Min(MaxRings, FMath::CeilToInt32(FMath::Min(maxRadius, CellSize * MaxRings) / CellSize));
+	int32 visitedCells = 0;
+	bool bFound = false;
+	for (int32 ring = 0; ring <= ringLimit && visitedCells < Cells.Num(); ring++)
+	{
+		auto visitCell = [&](int32 x, int32 y)
+		{
+			const TArray<int32>* cell = Cells.Find(FIntPoint(x, y));
+			if (!cell)
+				return;
+			visitedCells++;
+			for (const int32 index : *cell)
+			{
+				const FCombatSpatialEntry& entry = Entries[index];
+				if (EnumHasAnyFlags(entry.Kind, kinds) && entry.Object.IsValid())
+					gather(entry);
+			}
+		};
+		if (ring == 0)
+		{
+			visitCell(origin.X, origin.Y);
+		}
+		else
+		{
+			for (int32 i = -ring; i <= ring; i++)
+			{
+				visitCell(origin.X + i, origin.Y - ring);
+				visitCell(origin.X + i, origin.Y + ring);
+			}
+			for (int32 i = -ring + 1; i <= ring - 1; i++)
+			{
+				visitCell(origin.X - ring, origin.Y + i);
+				visitCell(origin.X + ring, origin.Y + i);
+			}
+		}
+		if (candidates.Num() >= count)
+		{
+			candidates.Sort(byDistance);
+			const float reached = ring * CellSize;
+			if (candidates[count - 1].Key <= reached * reached)
+			{
+				bFound = true;
+				break;
+			}
+		}
+	}
+
+	if (!bFound && visitedCells < Cells.Num() && maxRadius > ringLimit * CellSize)
+	{
+		candidates.Reset();
+		for (const FCombatSpatialEntry& entry : Entries)
+		{
+			if (EnumHasAnyFlags(entry.Kind, kinds) && entry.Object.IsValid())
+				gather(entry);
+		}
+	}
+
+	candidates.Sort(byDistance);
+	const int32 resultCount = FMath::Min(count, candidates.Num());
+	outResults.Reserve(resultCount);
+	for (int32 i = 0; i < resultCount; i++)
+		outResults.Add(candidates[i].Value);
+}
+
+void FCombatSpatialGrid::QueryCone(const FVector& origin, const FVector& direction, float halfAngleDegrees, float length, ECombatSpatialKind kinds, TArray<UObject*>& outResults) const
+{
+	outResults.Reset();
+	const FVector forward = direction.GetSafeNormal2D();
+	if (forward.IsNearlyZero())
+		return;
+	const float cosHalfAngle = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(halfAngleDegrees, 0.f, 180.f)));
+	const float lengthSq = length * length;
+	const FVector extent(length, length, 0);
+	TArray<TPair<float, UObject*>, TInlineAllocator<16>> candidates;
+	ForEachInBox(origin - extent, origin + extent, kinds, [&](const FCombatSpatialEntry& entry)
+	{
+		const FVector offset = (entry.Location - origin) * FVector(1, 1, 0);
+		const float distSq = offset.SizeSquared();
+		if (distSq > lengthSq)
+			return;
+		if (distSq > UE_KINDA_SMALL_NUMBER && (offset.Dot(forward) / FMath::Sqrt(distSq)) < cosHalfAngle)
+			return;
+		candidates.Emplace(distSq, entry.Object.Get());
+	});
+	candidates.Sort([](const TPair<float, UObject*>& a, const TPair<float, UObject*>& b) { return a.Key < b.Key; });
+	outResults.Reserve(candidates.Num());
+	for (const auto& candidate : candidates)
+		outResults.Add(candidate.Value);
+}
+
+void FCombatSpatialGrid::QueryLine(const FVector& start, const FVector& end, float radius, ECombatSpatialKind kinds, TArray<UObject*>& outResults) const
+{
+	outResults.Reset();
+	const FVector flatStart(start.X, start.Y, 0);
+	const FVector flatEnd(end.X, end.Y, 0);
+	const FVector extent(radius, radius, 0);
+	const FVector boxMin = flatStart.ComponentMin(flatEnd) - extent;
+	const FVector boxMax = flatStart.ComponentMax(flatEnd) + extent;
+	const float radiusSq = radius * radius;
+	TArray<TPair<float, UObject*>, TInlineAllocator<16>> candidates;
+	ForEachInBox(boxMin, boxMax, kinds, [&](const FCombatSpatialEntry& entry)
+	{
+		const FVector flatLocation(entry.Location.X, entry.Location.Y, 0);
+		const FVector closest = FMath::ClosestPointOnSegment(flatLocation, flatStart, flatEnd);
+		if (FVector::DistSquared(closest, flatLocation) > radiusSq)
+			return;
+		candidates.Emplace(FVector::DistSquared(closest, flatStart), entry.Object.Get());
+	});
+	candidates.Sort([](const TPair<float, UObject*>& a, const TPair<float, UObject*>& b) { return a.Key < b.Key; });
+	outResults.Reserve(candidates.Num());
+	for (const auto& candidate : candidates)
+		outResults.Add(candidate.Value);
+}
@@ -0,0 +1,77 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+
+#include "Combat/CombatTelemetry.h"
+#include "Actors/CombatManager.h"
+#include "SubSystems/CombatSubSystem.h"
+#include "CodeNameKibarun.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+
+void FCombatTelemetry::Reset()
+{
+	*this = FCombatTelemetry();
+	PhaseStartTime = FPlatformTime::Seconds();
+}
+
+void FCombatTelemetry::SwitchPhase(uint8 lastPhase, double time)
+{
+	if (lastPhase < MaxPhases)
+		PhaseDurations[lastPhase] += time - PhaseStartTime;
+	PhaseStartTime = time;
+}
+
+void FCombatTelemetry::BeginWave(double time)
+{
+	EndWave(time);
+	WaveStartTime = time;
+}
+
+void FCombatTelemetry::EndWave(double time)
+{
+	if (WaveStartTime >= 0)
+		WaveDuration.Add(time - WaveStartTime);
+	WaveStartTime = -1;
+}
+
+void FCombatTelemetry::Dump(const FString& combatName, const UEnum* phaseEnum) const
+{
+	UE_LOG(LogCombat, Display, TEXT("%s telemetry:"), *combatName);
+	for (int32 i = 0; i < MaxPhases; i++)
+	{
+		if (PhaseDurations[i] > 0)
+			UE_LOG(LogCombat, Display, TEXT("  Phase %s: %.2fs"), phaseEnum ? *phaseEnum->GetNameStringByValue(i) : *FString::FromInt(i), PhaseDurations[i]);
+	}
+	auto dumpSeries = [](const TCHAR* name, const FCombatTelemetrySeries& series)
+	{
+		UE_LOG(LogCombat, Display, TEXT("  %s: %d samples, avg %.3fs, min %.3fs, max %.3fs"), name, series.Count, series.GetAverage(), series.Min, series.Max);
+	};
+	dumpSeries(TEXT("Asset latency"), AssetLatency);
+	dumpSeries(TEXT("Spawn to anchor"), SpawnToAnchor);
+	dumpSeries(TEXT("Wave duration"), WaveDuration);
+	UE_LOG(LogCombat, Display, TEXT("  Peak enemies alive: %d"), PeakEnemiesAlive);
+}
+
+
+// Print the telemetry of each combat
+static FAutoConsoleCommandWithWorldAndArgs GCombatTelemetryCommand(
+	TEXT("Kibarun.Combat.Telemetry"),
+	TEXT("Log the phase, spawn and wave timings of each combat, in every world."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (!GEngine)
+			return;
+		for (const FWorldContext& context : GEngine->GetWorldContexts())
+		{
+			UWorld* world = context.World();
+			auto subSys = world ? world->GetSubsystem<UCombatSubSystem>() : nullptr;
+			if (!subSys)
+				continue;
+			for (auto combat : subSys->GetCombatManagers())
+			{
+				if (combat)
+					combat->GetTelemetry().Dump(FString::Printf(TEXT("%s (%s)"), *combat->GetName(), *world->GetName()), StaticEnum<ECombatPhase>());
+			}
+		}
+	}));
@@ -7,11 +7,9 @@
 void UCharacterAnchor::OnOwnerDestroyed_internal(AActor* actor)
 {
 	if (_linkedCharacter.IsValid() && actor == _linkedCharacter)
-	{
 		_linkedCharacter->OnDestroyed.RemoveDynamic(this, &UCharacterAnchor::OnOwnerDestroyed_internal);
-		_linkedCharacter->OnCharacterDied.RemoveDynamic(this, &UCharacterAnchor::OnOwnerDestroyed_internal);
-	}
 	_linkedCharacter = nullptr;
+	UpdateAnchor();
 }
 
 void UCharacterAnchor::OnBeginOverlap_internal(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep,
@@ -19,12 +17,14 @@ void UCharacterAnchor::OnBeginOverlap_internal(UPrimitiveComponent* OverlappedCo
 {
 	if (OtherActor != _linkedCharacter)
 		return;
+	UpdateAnchor();
 }
 
 void UCharacterAnchor::OnEndOverlap_internal(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
 {
 	if (OtherActor != _linkedCharacter)
 		return;
+	UpdateAnchor();
 }
 
 UCharacterAnchor::UCharacterAnchor()
@@ -71,17 +71,13 @@ bool UCharacterAnchor::UpdateAnchor()
 
 void UCharacterAnchor::SetNewOwner(ABaseGasCharacter* NewOwner)
 {
+	// Dead owners are released by the combat manager death pipeline
 	if (_linkedCharacter.IsValid())
-	{
 		_linkedCharacter->OnDestroyed.RemoveDynamic(this, &UCharacterAnchor::OnOwnerDestroyed_internal);
-		_linkedCharacter->OnCharacterDied.RemoveDynamic(this, &UCharacterAnchor::OnOwnerDestroyed_internal);
-	}
 	_linkedCharacter = NewOwner;
 	if (_linkedCharacter.IsValid())
-	{
 		_linkedCharacter->OnDestroyed.AddDynamic(this, &UCharacterAnchor::OnOwnerDestroyed_internal);
-		_linkedCharacter->OnCharacterDied.AddDynamic(this, &UCharacterAnchor::OnOwnerDestroyed_internal);
-	}
 	if (_linkedCharacter.IsValid())
 		_linkedCharacter->SetNewAnchor(this);
+	UpdateAnchor();
 }
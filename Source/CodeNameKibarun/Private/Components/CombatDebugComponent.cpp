@@ -0,0 +1,75 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+
+#include "Components/CombatDebugComponent.h"
+#include "Actors/CombatManager.h"
+#include "DrawDebugHelpers.h"
+#include "UObject/UObjectIterator.h"
+
+
+#if ENABLE_DRAW_DEBUG
+// The components only tick while drawing
+static void OnCombatDebugDrawChanged(IConsoleVariable* Variable)
+{
+	const bool enabled = Variable->GetBool();
+	for (TObjectIterator<UCombatDebugComponent> it; it; ++it)
+	{
+		if (it->IsRegistered() && it->HasBegunPlay())
+			it->SetComponentTickEnabled(enabled);
+	}
+}
+
+static TAutoConsoleVariable<bool> CVarCombatDebugDraw(
+	TEXT("Kibarun.Combat.DebugDraw"),
+	false,
+	TEXT("Draw the combat managers anchors and their state"),
+	FConsoleVariableDelegate::CreateStatic(&OnCombatDebugDrawChanged),
+	ECVF_Cheat);
+#endif
+
+
+UCombatDebugComponent::UCombatDebugComponent()
+{
+#if ENABLE_DRAW_DEBUG
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.bTickEvenWhenPaused = true;
+#else
+	PrimaryComponentTick.bCanEverTick = false;
+#endif
+	bAutoActivate = true;
+}
+
+void UCombatDebugComponent::BeginPlay()
+{
+	Super::BeginPlay();
+#if ENABLE_DRAW_DEBUG
+	SetComponentTickEnabled(CVarCombatDebugDraw.GetValueOnGameThread());
+#endif
+}
+
+void UCombatDebugComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+#if ENABLE_DRAW_DEBUG
+	if (!CVarCombatDebugDraw.GetValueOnGameThread())
+		return;
+	const auto combatManager = Cast<ACombatManager>(GetOwner());
+	if (!combatManager)
+		return;
+
+	auto drawAnchors = [this](const TArray<TObjectPtr<UCharacterAnchor>>& anchors)
+	{
+		for (const auto& anchor : anchors)
+		{
+			if (!anchor)
+				continue;
+			const FColor color = anchor->GetAnchorState() == EAnchorState::Free ? FColor::Green : (anchor->GetAnchorState() == EAnchorState::Occupied ? FColor::Red : FColor::Blue);
+			DrawDebugSphere(GetWorld(), anchor->GetComponentLocation(), AnchorRadius, 12, color, false, -1.f, 0, 1.f);
+		}
+	};
+	drawAnchors(combatManager->GetHeroAnchors());
+	drawAnchors(combatManager->GetEnemyAnchors());
+#endif
+}
@@ -0,0 +1,71 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+
+#include "Components/CombatSignificanceComponent.h"
+#include "Actors/CombatManager.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+
+
+UCombatSignificanceComponent::UCombatSignificanceComponent()
+{
+	// Ranking is not needed every frame, characters don't change significance that fast
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+	PrimaryComponentTick.TickInterval = 0.25f;
+	bAutoActivate = true;
+}
+
+void UCombatSignificanceComponent::SetSignificanceBudget(int32 highCount, int32 mediumCount)
+{
+	HighSignificanceBudget = FMath::Max(0, highCount);
+	MediumSignificanceBudget = FMath::Max(0, mediumCount);
+}
+
+void UCombatSignificanceComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	const auto combatManager = Cast<ACombatManager>(GetOwner());
+	if (!combatManager)
+		return;
+	FVector viewLocation = combatManager->GetActorLocation();
+	if (auto plController = combatManager->GetCombatPlayerController())
+	{
+		if (plController->PlayerCameraManager)
+			viewLocation = plController->PlayerCameraManager->GetCameraLocation();
+	}
+
+	for (auto hero : combatManager->GetHeroesInScene())
+	{
+		if (hero)
+			hero->ApplySignificance(ECombatSignificance::High, 0);
+	}
+
+	// Closest first, enemies without anchor have nowhere to go and come last
+	const double lowDistanceSq = FMath::Square(LowSignificanceDistance);
+	_rankedEnemies.Reset();
+	for (auto enemy : combatManager->GetEnemiesInScene())
+	{
+		if (!enemy)
+			continue;
+		double score = FVector::DistSquared(enemy->GetActorLocation(), viewLocation);
+		if (!enemy->Anchor || !enemy->IsCharacterAlive() || score > lowDistanceSq)
+			score += lowDistanceSq * 2;
+		_rankedEnemies.Emplace(score, enemy);
+	}
+	_rankedEnemies.Sort([](const TPair<double, ABaseGasCharacter*>& a, const TPair<double, ABaseGasCharacter*>& b) { return a.Key < b.Key; });
+
+	for (int32 i = 0; i < _rankedEnemies.Num(); i++)
+	{
+		ABaseGasCharacter* enemy = _rankedEnemies[i].Value;
+		if (_rankedEnemies[i].Key > lowDistanceSq)
+			enemy->ApplySignificance(ECombatSignificance::Low, LowTickInterval);
+		else if (i < HighSignificanceBudget)
+			enemy->ApplySignificance(ECombatSignificance::High, 0);
+		else if (i < HighSignificanceBudget + MediumSignificanceBudget)
+			enemy->ApplySignificance(ECombatSignificance::Medium, MediumTickInterval);
+		else
+			enemy->ApplySignificance(ECombatSignificance::Low, LowTickInterval);
+	}
+}
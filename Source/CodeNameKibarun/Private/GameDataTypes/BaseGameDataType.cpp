@@ -14,5 +14,7 @@ TArray<FName> UBaseGameDataType::GetDataBundleFromFlags(int32 flag)
 		result.Add(BUNDLE_SPAWN);
 	if(flag & static_cast<int32>(EDataBundleType::Accessories))
 		result.Add(BUNDLE_ACCESSORY);
+	if(flag & static_cast<int32>(EDataBundleType::Proxy))
+		result.Add(BUNDLE_PROXY);
 	return result;
 }
@@ -3,3 +3,87 @@
 
 #include "GameDataTypes/CombatData.h"
 
+
+void FCompiledWaveSchedule::Compile(const TArray<FEnemyWave>& enemyWaves)
+{
+	Compile(enemyWaves, FCombatDifficulty(), 0);
+}
+
+void FCompiledWaveSchedule::Compile(const TArray<FEnemyWave>& enemyWaves, const FCombatDifficulty& difficulty, int32 stageIndex)
+{
+	const int32 extraEnemies = difficulty.GetExtraEnemies(stageIndex);
+	Enemies.Reset();
+	Waves.Reset();
+	for (const auto& enemyWave : enemyWaves)
+	{
+		FCompiledWave wave;
+		wave.SpawnMode = enemyWave.SpawnMode;
+		wave.SpawnDelay = enemyWave.SpawnDelay * FMath::Max(0.f, difficulty.SpawnDelayMultiplier);
+		wave.MaxInFlightSpawns = FMath::Max(1, enemyWave.MaxInFlightSpawns);
+		wave.SpawnBurst = FMath::Max(1, enemyWave.SpawnBurst);
+		switch (enemyWave.SpawnMode)
+		{
+			case EWaveSpawnMode::OnAllAnchorsFree:
+				wave.FreeAnchorPercent = 1;
+				wave.bGateFirstSpawnOnly = true;
+				break;
+			case EWaveSpawnMode::OnTwoAnchorsFree:
+				wave.FreeAnchorCount = 2;
+				wave.bGateFirstSpawnOnly = true;
+				break;
+			case EWaveSpawnMode::OnOneAnchorsFree:
+				wave.FreeAnchorCount = 1;
+				break;
+			case EWaveSpawnMode::Custom:
+				wave.FreeAnchorCount = FMath::Max(1, enemyWave.FreeAnchorCount);
+				wave.FreeAnchorPercent = FMath::Clamp(enemyWave.FreeAnchorPercent, 0.f, 1.f);
+				wave.bGateFirstSpawnOnly = enemyWave.bGateFirstSpawnOnly;
+				break;
+			default:
+				break;
+		}
+		wave.FirstEnemy = Enemies.Num();
+		for (const auto& enemy : enemyWave.WaveEnemies)
+		{
+			if (enemy.IsValid())
+				Enemies.Add(enemy);
+		}
+		wave.EnemyCount = Enemies.Num() - wave.FirstEnemy;
+		// Extra enemies cycle through the wave ones, so nothing more has to be loaded
+		for (int32 extra = 0; wave.EnemyCount > 0 && extra < extraEnemies; extra++)
+		{
+			const FPrimaryAssetId enemy = Enemies[wave.FirstEnemy + extra % wave.EnemyCount];
+			Enemies.Add(enemy);
+		}
+		wave.EnemyCount = Enemies.Num() - wave.FirstEnemy;
+		if (wave.EnemyCount > 0)
+			Waves.Add(wave);
+	}
+	Enemies.Shrink();
+	Waves.Shrink();
+}
+
+void UCombatData::PostLoad()
+{
+	Super::PostLoad();
+	WaveSchedule.Compile(EnemyWaves);
+	bIsScheduleCompiled = true;
+}
+
+#if WITH_EDITOR
+void UCombatData::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	bIsScheduleCompiled = false;
+}
+#endif
+
+const FCompiledWaveSchedule& UCombatData::GetWaveSchedule()
+{
+	if (!bIsScheduleCompiled)
+	{
+		WaveSchedule.Compile(EnemyWaves);
+		bIsScheduleCompiled = true;
+	}
+	return WaveSchedule;
+}
@@ -0,0 +1,84 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+
+#include "Movement/RootMotionSource_EasedMoveTo.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+
+FRootMotionSource_EasedMoveTo::FRootMotionSource_EasedMoveTo()
+{
+	// The eased curve gives the whole movement, nothing to add on top
+	AccumulateMode = ERootMotionAccumulateMode::Override;
+}
+
+FRootMotionSource* FRootMotionSource_EasedMoveTo::Clone() const
+{
+	return new FRootMotionSource_EasedMoveTo(*this);
+}
+
+bool FRootMotionSource_EasedMoveTo::Matches(const FRootMotionSource* Other) const
+{
+	if (!FRootMotionSource::Matches(Other))
+		return false;
+	// Same type is checked by the parent
+	const auto other = static_cast<const FRootMotionSource_EasedMoveTo*>(Other);
+	return Easing == other->Easing && FMath::IsNearlyEqual(Delay, other->Delay) && TargetLocation.Equals(other->TargetLocation);
+}
+
+bool FRootMotionSource_EasedMoveTo::MatchesAndHasSameState(const FRootMotionSource* Other) const
+{
+	if (!FRootMotionSource::MatchesAndHasSameState(Other))
+		return false;
+	return StartLocation.Equals(static_cast<const FRootMotionSource_EasedMoveTo*>(Other)->StartLocation);
+}
+
+bool FRootMotionSource_EasedMoveTo::UpdateStateFrom(const FRootMotionSource* SourceToTakeStateFrom, bool bMarkForSimulatedCatchup)
+{
+	if (!FRootMotionSource::UpdateStateFrom(SourceToTakeStateFrom, bMarkForSimulatedCatchup))
+		return false;
+	StartLocation = static_cast<const FRootMotionSource_EasedMoveTo*>(SourceToTakeStateFrom)->StartLocation;
+	return true;
+}
+
+FVector FRootMotionSource_EasedMoveTo::GetLocationAtTime(float time) const
+{
+	const float moveTime = Duration - Delay;
+	const float alpha = moveTime > UE_SMALL_NUMBER ? FMath::Clamp((time - Delay) / moveTime, 0.f, 1.f) : 1.f;
+	return FMath::Lerp(StartLocation, TargetLocation, FCEasing::Ease(alpha, Easing));
+}
+
+void FRootMotionSource_EasedMoveTo::PrepareRootMotion(float SimulationTime, float MovementTickTime, const ACharacter& Character, const UCharacterMovementComponent& MoveComponent)
+{
+	RootMotionParams.Clear();
+	if (Duration > UE_SMALL_NUMBER && MovementTickTime > UE_SMALL_NUMBER)
+	{
+		// Velocity to reach the curve location at the end of this movement step
+		const FVector targetLocation = GetLocationAtTime(GetTime() + SimulationTime);
+		const FVector velocity = (targetLocation - Character.GetActorLocation()) / MovementTickTime;
+		RootMotionParams.Set(FTransform(velocity));
+	}
+	SetTime(GetTime() + SimulationTime);
+}
+
+bool FRootMotionSource_EasedMoveTo::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	if (!FRootMotionSource::NetSerialize(Ar, Map, bOutSuccess))
+		return false;
+	Ar << StartLocation;
+	Ar << TargetLocation;
+	Ar << Delay;
+	Ar << Easing;
+	bOutSuccess = true;
+	return true;
+}
+
+UScriptStruct* FRootMotionSource_EasedMoveTo::GetScriptStruct() const
+{
+	return FRootMotionSource_EasedMoveTo::StaticStruct();
+}
+
+FString FRootMotionSource_EasedMoveTo::ToSimpleString() const
+{
+	return FString::Printf(TEXT("[ID:%u]FRootMotionSource_EasedMoveTo %s"), LocalID, *InstanceName.GetPlainNameString());
+}
@@ -0,0 +1,325 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+
+#include "Simulation/CombatSimulator.h"
+#include "CodeNameKibarun.h"
+#include "Engine/AssetManager.h"
+
+
+float FCombatSimulationReport::GetSpawnLatencyPercentile(float percentile) const
+{
+	if (SpawnLatencies.IsEmpty())
+		return 0;
+	TArray<float> sorted = SpawnLatencies;
+	sorted.Sort();
+	const int32 index = FMath::Clamp(FMath::FloorToInt32(percentile * (sorted.Num() - 1)), 0, sorted.Num() - 1);
+	return sorted[index];
+}
+
+void FCombatSimulationReport::Append(const FCombatSimulationReport& other)
+{
+	Runs += other.Runs;
+	CompletedRuns += other.CompletedRuns;
+	Ticks += other.Ticks;
+	WallSeconds += other.WallSeconds;
+	SimulatedSeconds += other.SimulatedSeconds;
+	SpawnLatencies.Append(other.SpawnLatencies);
+	WaveCompletionTimes.Append(other.WaveCompletionTimes);
+}
+
+void FCombatSimulationReport::Reset()
+{
+	*this = FCombatSimulationReport();
+}
+
+void FCombatSimulationReport::Dump(const FString& title) const
+{
+	UE_LOG(LogCombat, Display, TEXT("%s: %d/%d runs completed, %lld ticks in %.3fs (%.0f ticks/s), %.1fs simulated per run"),
+		   *title, CompletedRuns, Runs, Ticks, WallSeconds, GetTicksPerSecond(), Runs > 0 ? SimulatedSeconds / Runs : 0.0);
+	UE_LOG(LogCombat, Display, TEXT("%s: spawn latency over %d spawns: p50 %.2fs, p90 %.2fs, p99 %.2fs, max %.2fs"),
+		   *title, SpawnLatencies.Num(), GetSpawnLatencyPercentile(0.5f), GetSpawnLatencyPercentile(0.9f), GetSpawnLatencyPercentile(0.99f), GetSpawnLatencyPercentile(1.f));
+
+	int32 waveCount = 0;
+	for (const auto& runWaves : WaveCompletionTimes)
+		waveCount = FMath::Max(waveCount, runWaves.Num());
+	for (int32 wave = 0; wave < waveCount; wave++)
+	{
+		double total = 0;
+		float longest = 0;
+		int32 completed = 0;
+		for (const auto& runWaves : WaveCompletionTimes)
+		{
+			if (!runWaves.IsValidIndex(wave) || runWaves[wave] < 0)
+				continue;
+			total += runWaves[wave];
+			longest = FMath::Max(longest, runWaves[wave]);
+			completed++;
+		}
+		UE_LOG(LogCombat, Display, TEXT("%s: wave %d completed %d times, mean %.2fs, max %.2fs"), *title, wave, completed, completed > 0 ? total / completed : 0.0, longest);
+	}
+}
+
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+
+// Distance between two simulated anchors, enemies spawn one step behind the back-most anchor
+static constexpr float SimulatedAnchorSpacing = 100.f;
+
+FCombatSimulator::FCombatSimulator(const FCompiledWaveSchedule& schedule)
+	: Schedule(schedule)
+{
+}
+
+bool FCombatSimulator::Run(const FCombatSimulationSettings& settings, FCombatSimulationReport& report)
+{
+	Settings = settings;
+	Stream.Initialize(settings.Seed);
+	Phase = ECombatPhase::Opening;
+	Cursor.Reset();
+	Enemies.Reset();
+	Anchors.SetNum(FMath::Max(1, settings.EnemyAnchorCount));
+	for (int32 i = 0; i < Anchors.Num(); i++)
+	{
+		Anchors[i] = FCombatAnchorSlot();
+		Anchors[i].Location = FVector(i * SimulatedAnchorSpacing, 0, 0);
+	}
+	AnchorOwners.Init(INDEX_NONE, Anchors.Num());
+	SpawnLocation = FVector(Anchors.Num() * SimulatedAnchorSpacing, 0, 0);
+	bIsFormationDirty = false;
+	Waves.Reset();
+	Waves.SetNum(Schedule.Waves.Num());
+	Time = 0;
+	SpawnTimer = 0;
+	InFlightSpawns = 0;
+
+	TArray<float> waveTimes;
+	waveTimes.Init(-1.f, Schedule.Waves.Num());
+	const float deltaTime = FMath::Max(KINDA_SMALL_NUMBER, settings.TickDeltaTime);
+	const double startTime = FPlatformTime::Seconds();
+	int64 ticks = 0;
+
+	// The hero reaches its anchor right away
+	CreateNextWave();
+	while (Phase != ECombatPhase::Ended && Time < settings.MaxSimulatedTime)
+	{
+		Tick(deltaTime, report, waveTimes);
+		ticks++;
+	}
+
+	const bool completed = Phase == ECombatPhase::Ended;
+	report.Runs++;
+	report.CompletedRuns += completed ? 1 : 0;
+	report.Ticks += ticks;
+	report.WallSeconds += FPlatformTime::Seconds() - startTime;
+	report.SimulatedSeconds += Time;
+	report.WaveCompletionTimes.Add(MoveTemp(waveTimes));
+	return completed;
+}
+
+float FCombatSimulator::Vary(float value)
+{
+	return FMath::Max(0.f, value * (1.f + Stream.FRandRange(-Settings.Jitter, Settings.Jitter)));
+}
+
+void FCombatSimulator::Tick(float deltaTime, FCombatSimulationReport& report, TArray<float>& waveTimes)
+{
+	Time += deltaTime;
+	SpawnTimer = FMath::Max(0.f, SpawnTimer - deltaTime);
+	for (int32 i = 0; i < Enemies.Num(); i++)
+	{
+		FSimEnemy& enemy = Enemies[i];
+		switch (enemy.State)
+		{
+			case EEnemyState::Loading:
+				enemy.Timer -= deltaTime;
+				if (enemy.Timer <= 0)
+				{
+					// Loaded, on the anchor kept for it, or held until one frees up
+					if (Anchors.IsValidIndex(enemy.Anchor))
+						Anchors[enemy.Anchor].bSpawnReserved = false;
+					if (!Anchors.IsValidIndex(enemy.Anchor) || !Anchors[enemy.Anchor].IsFree())
+						enemy.Anchor = FCombatRules::FindSpawnAnchor(Anchors);
+					if (enemy.Anchor == INDEX_NONE)
+						break;
+					InFlightSpawns = FMath::Max(0, InFlightSpawns - 1);
+					enemy.State = EEnemyState::Travelling;
+					enemy.Timer = Vary(Settings.TravelTime);
+					SetAnchorOwner(enemy.Anchor, i);
+					bIsFormationDirty = true;
+				}
+				break;
+			case EEnemyState::Travelling:
+				enemy.Timer -= deltaTime;
+				if (enemy.Timer <= 0)
+				{
+					enemy.State = EEnemyState::OnAnchor;
+					enemy.Location = Anchors[enemy.Anchor].Location;
+					Anchors[enemy.Anchor].OwnerLocation = enemy.Location;
+					if (!enemy.bReachedOnce)
+					{
+						enemy.bReachedOnce = true;
+						enemy.Life = Vary(Settings.EnemyLifeTime);
+						report.SpawnLatencies.Add(Time - enemy.RequestTime);
+					}
+					// The opening ends, and the camera is instantly ready: Begining goes straight to Active
+					if (enemy.Anchor == Anchors.Num() - 1 && Phase == ECombatPhase::Opening)
+						Phase = ECombatPhase::Active;
+				}
+				break;
+			case EEnemyState::OnAnchor:
+				enemy.Life -= deltaTime;
+				if (enemy.Life <= 0)
+				{
+					enemy.State = EEnemyState::Dead;
+					SetAnchorOwner(enemy.Anchor, INDEX_NONE);
+					enemy.Anchor = INDEX_NONE;
+					bIsFormationDirty = true;
+					if (Waves.IsValidIndex(enemy.Wave) && ++Waves[enemy.Wave].Dead >= Schedule.Waves[enemy.Wave].EnemyCount)
+						waveTimes[enemy.Wave] = Time - Waves[enemy.Wave].StartTime;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+	if (bIsFormationDirty)
+		SolveFormation();
+	if (FCombatRules::SpawnsDuring(Phase) && FCombatRules::FindSpawnAnchor(Anchors) != INDEX_NONE)
+		TrySpawnEnemy();
+}
+
+void FCombatSimulator::SetAnchorOwner(int32 anchor, int32 enemyIndex)
+{
+	if (!Anchors.IsValidIndex(anchor))
+		return;
+	AnchorOwners[anchor] = enemyIndex;
+	Anchors[anchor].bHasOwner = enemyIndex != INDEX_NONE;
+	Anchors[anchor].OwnerLocation = Enemies.IsValidIndex(enemyIndex) ? Enemies[enemyIndex].Location : FVector::ZeroVector;
+}
+
+void FCombatSimulator::SolveFormation()
+{
+	bIsFormationDirty = false;
+	if (!Rules.SolveFormation(Anchors, FormationMoves))
+		return;
+	// Same order as the manager: release every anchor changing hands, then give them their new owner
+	TArray<int32, TInlineAllocator<32>> movingEnemies;
+	for (const auto& move : FormationMoves)
+	{
+		movingEnemies.Add(AnchorOwners[move.Key]);
+		SetAnchorOwner(move.Key, INDEX_NONE);
+	}
+	for (int32 i = 0; i < FormationMoves.Num(); i++)
+	{
+		FSimEnemy& enemy = Enemies[movingEnemies[i]];
+		SetAnchorOwner(FormationMoves[i].Value, movingEnemies[i]);
+		enemy.Anchor = FormationMoves[i].Value;
+		// Enemies still on their way keep the rest of their travel
+		if (enemy.State == EEnemyState::OnAnchor)
+		{
+			enemy.State = EEnemyState::Travelling;
+			enemy.Timer = Vary(Settings.ShiftTime);
+		}
+	}
+}
+
+void FCombatSimulator::TrySpawnEnemy()
+{
+	const FCompiledWave* wave = Cursor.GetWave(Schedule);
+	if (!FCombatRules::CanStartSpawn(wave, InFlightSpawns) || SpawnTimer > 0)
+		return;
+	for (int32 burst = 0; burst < wave->SpawnBurst; burst++)
+	{
+		FPrimaryAssetId enemyID;
+		const ECombatSpawnStep step = FCombatRules::PopNextSpawn(Schedule, Cursor, Anchors, InFlightSpawns, enemyID);
+		if (step == ECombatSpawnStep::Blocked)
+			return;
+		if (step == ECombatSpawnStep::WaveDone)
+		{
+			CreateNextWave();
+			return;
+		}
+		// Load the enemy, keeping the spawn anchor for it
+		InFlightSpawns++;
+		const int32 enemyIndex = Enemies.AddDefaulted();
+		FSimEnemy& enemy = Enemies[enemyIndex];
+		enemy.Wave = Cursor.WaveIndex;
+		enemy.RequestTime = Time;
+		enemy.Timer = Vary(Settings.AssetLoadTime);
+		enemy.Location = SpawnLocation;
+		enemy.Anchor = FCombatRules::FindSpawnAnchor(Anchors);
+		Anchors[enemy.Anchor].bSpawnReserved = true;
+	}
+}
+
+void FCombatSimulator::CreateNextWave()
+{
+	if (Cursor.NextWave(Schedule))
+	{
+		Waves[Cursor.WaveIndex].StartTime = Time;
+		if (Schedule.Waves[Cursor.WaveIndex].SpawnDelay > 0.f)
+			SpawnTimer = Schedule.Waves[Cursor.WaveIndex].SpawnDelay;
+	}
+	else if (Phase == ECombatPhase::Active && CountAlive() == 0)
+	{
+		// Ending, with an instant outro traversal
+		Phase = ECombatPhase::Ended;
+	}
+}
+
+int32 FCombatSimulator::CountAlive() const
+{
+	int32 aliveCount = 0;
+	for (const auto& enemy : Enemies)
+	{
+		if (enemy.State != EEnemyState::Loading && enemy.State != EEnemyState::Dead)
+			aliveCount++;
+	}
+	return aliveCount;
+}
+
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+
+static void SimulateCombatCommand(const TArray<FString>& Args)
+{
+	if (Args.IsEmpty())
+	{
+		UE_LOG(LogCombat, Warning, TEXT("Usage: Kibarun.Combat.Simulate <CombatData:Name> [Runs=100] [Seed=0] [EnemyAnchors=3]"));
+		return;
+	}
+	auto mgr = UAssetManager::GetIfInitialized();
+	if (!mgr)
+		return;
+	const FPrimaryAssetId combatID = FPrimaryAssetId::FromString(Args[0]);
+	if (auto handle = mgr->LoadPrimaryAsset(combatID, { BUNDLE_INFOS }))
+		handle->WaitUntilComplete();
+	const auto combatData = mgr->GetPrimaryAssetObject<UCombatData>(combatID);
+	if (!combatData)
+	{
+		UE_LOG(LogCombat, Warning, TEXT("Kibarun.Combat.Simulate: cannot load %s"), *Args[0]);
+		return;
+	}
+
+	FCombatSimulationSettings settings;
+	const int32 runs = Args.IsValidIndex(1) ? FMath::Max(1, FCString::Atoi(*Args[1])) : 100;
+	const int32 seed = Args.IsValidIndex(2) ? FCString::Atoi(*Args[2]) : 0;
+	if (Args.IsValidIndex(3))
+		settings.EnemyAnchorCount = FMath::Max(1, FCString::Atoi(*Args[3]));
+
+	FCombatSimulator simulator(combatData->GetWaveSchedule());
+	FCombatSimulationReport report;
+	for (int32 run = 0; run < runs; run++)
+	{
+		settings.Seed = seed + run;
+		simulator.Run(settings, report);
+	}
+	report.Dump(combatID.ToString());
+}
+
+static FAutoConsoleCommand CCmdSimulateCombat(
+	TEXT("Kibarun.Combat.Simulate"),
+	TEXT("Run a combat data to completion without world nor rendering, and log throughput, spawn latencies and wave times. Args: <CombatData:Name> [Runs=100] [Seed=0] [EnemyAnchors=3]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&SimulateCombatCommand));
@@ -0,0 +1,184 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+
+#include "SubSystems/AnchorMoveSubsystem.h"
+#include "CodeNameKibarun.h"
+#include "Actors/BaseGasCharacter.h"
+#include "AIController.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "NavFilters/NavigationQueryFilter.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "Navigation/CrowdFollowingComponent.h"
+
+
+DECLARE_CYCLE_STAT(TEXT("Anchor Move Requests"), STAT_CombatAnchorMoves, STATGROUP_Combat);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pending Anchor Moves"), STAT_CombatPendingAnchorMoves, STATGROUP_Combat);
+
+static TAutoConsoleVariable<int32> CVarAnchorMovesPerFrame(
+	TEXT("Kibarun.Combat.AnchorMovesPerFrame"),
+	8,
+	TEXT("How many anchor move requests are resolved per frame"),
+	ECVF_Default);
+
+
+TStatId UAnchorMoveSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAnchorMoveSubsystem, STATGROUP_Tickables);
+}
+
+void UAnchorMoveSubsystem::RequestAnchorMove(ABaseGasCharacter* Character, const FVector& Goal, float AcceptanceRadius)
+{
+	if (!Character)
+		return;
+	const TObjectKey<ABaseGasCharacter> key(Character);
+	auto& request = _requests.FindOrAdd(key);
+	request.Character = Character;
+	request.Goal = Goal;
+	request.AcceptanceRadius = AcceptanceRadius;
+	// A query still in flight is now stale, its result is dropped
+	request.QueryID = INVALID_NAVQUERYID;
+	if (!request.bIsQueued)
+	{
+		request.bIsQueued = true;
+		_queue.Add(key);
+	}
+}
+
+void UAnchorMoveSubsystem::CancelAnchorMove(ABaseGasCharacter* Character)
+{
+	if (Character)
+		_requests.Remove(Character);
+}
+
+void UAnchorMoveSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_CombatAnchorMoves);
+
+	int32 budget = FMath::Max(1, CVarAnchorMovesPerFrame.GetValueOnGameThread());
+	int32 processed = 0;
+	for (; processed < _queue.Num() && budget > 0; processed++)
+	{
+		auto request = _requests.Find(_queue[processed]);
+		// Cancelled, or already processed through an older queue entry
+		if (!request || !request->bIsQueued)
+			continue;
+		request->bIsQueued = false;
+		if (!ProcessRequest(_queue[processed], *request))
+			_requests.Remove(_queue[processed]);
+		budget--;
+	}
+	_queue.RemoveAt(0, processed, EAllowShrinking::No);
+	SET_DWORD_STAT(STAT_CombatPendingAnchorMoves, _requests.Num());
+}
+
+bool UAnchorMoveSubsystem::ProcessRequest(const TObjectKey<ABaseGasCharacter>& key, FAnchorMoveRequest& request)
+{
+	auto character = request.Character.Get();
+	auto controller = character ? character->GetController() : nullptr;
+	auto navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!controller || !navSystem)
+		return false;
+	const FNavAgentProperties& agentProperties = character->GetNavAgentPropertiesRef();
+	const FVector start = character->GetNavAgentLocation();
+	const ANavigationData* navData = navSystem->GetNavDataForProps(agentProperties, start);
+	if (!navData)
+		return false;
+	FSharedConstNavQueryFilter filter = UNavigationQueryFilter::GetQueryFilter(*navData, controller, nullptr);
+
+	// Straight line fast path. Crowd following needs the corridor of a real path query
+	auto pathFollowing = FindPathFollowing(controller);
+	FVector hitLocation;
+	if (pathFollowing && !pathFollowing->IsA<UCrowdFollowingComponent>()
+		&& !navData->Raycast(start, request.Goal, hitLocation, filter, controller))
+	{
+		FNavPathSharedPtr path = MakeShared<FNavigationPath>(TArray<FVector>{ start, request.Goal }, nullptr);
+		path->SetNavigationDataUsed(navData);
+		path->SetQuerier(controller);
+		StartMove(character, request, path);
+		return false;
+	}
+
+	FPathFindingQuery query(controller, *navData, start, request.Goal, filter);
+	request.QueryID = navSystem->FindPathAsync(agentProperties, query,
+		FNavPathQueryDelegate::CreateUObject(this, &UAnchorMoveSubsystem::OnPathFound_Internal), EPathFindingMode::Regular);
+	if (request.QueryID == INVALID_NAVQUERYID)
+		return false;
+	_pathQueries.Add(request.QueryID, key);
+	return true;
+}
+
+void UAnchorMoveSubsystem::OnPathFound_Internal(uint32 queryID, ENavigationQueryResult::Type result, FNavPathSharedPtr path)
+{
+	TObjectKey<ABaseGasCharacter> key;
+	if (!_pathQueries.RemoveAndCopyValue(queryID, key))
+		return;
+	auto request = _requests.Find(key);
+	// Cancelled or replaced while the path was searched
+	if (!request || request->QueryID != queryID)
+		return;
+	const FAnchorMoveRequest finished = *request;
+	_requests.Remove(key);
+	auto character = finished.Character.Get();
+	if (!character)
+		return;
+	if (result != ENavigationQueryResult::Success || !path.IsValid())
+	{
+		UE_LOG(LogCombat, Verbose, TEXT("%s found no path to its anchor"), *character->GetName());
+		return;
+	}
+	StartMove(character, finished, path);
+}
+
+bool UAnchorMoveSubsystem::StartMove(ABaseGasCharacter* character, const FAnchorMoveRequest& request, FNavPathSharedPtr path)
+{
+	auto controller = character->GetController();
+	auto pathFollowing = FindPathFollowing(controller);
+	if (!pathFollowing)
+		return false;
+	FAIMoveRequest moveRequest(request.Goal);
+	moveRequest.SetAcceptanceRadius(request.AcceptanceRadius);
+	moveRequest.SetReachTestIncludesAgentRadius(false);
+	FAIRequestID moveID;
+	if (auto aiController = Cast<AAIController>(controller))
+		moveID = aiController->RequestMove(moveRequest, path);
+	else
+		moveID = pathFollowing->RequestMove(moveRequest, path);
+	if (!moveID.IsValid())
+		return false;
+	_activeMoves.Add(character, moveID);
+	return true;
+}
+
+void UAnchorMoveSubsystem::OnMoveFinished_Internal(FAIRequestID requestID, const FPathFollowingResult& result, TWeakObjectPtr<AController> controller)
+{
+	auto character = controller.IsValid() ? Cast<ABaseGasCharacter>(controller->GetPawn()) : nullptr;
+	const TObjectKey<ABaseGasCharacter> key(character);
+	const auto activeMove = _activeMoves.Find(key);
+	if (!activeMove || *activeMove != requestID)
+		return;
+	_activeMoves.Remove(key);
+	if (result.IsSuccess() && character)
+		character->OnAnchorReached();
+}
+
+UPathFollowingComponent* UAnchorMoveSubsystem::FindPathFollowing(AController* controller)
+{
+	if (!controller)
+		return nullptr;
+	auto pathFollowing = controller->FindComponentByClass<UPathFollowingComponent>();
+	if (!pathFollowing)
+	{
+		// Same as UAIBlueprintHelperLibrary::SimpleMoveToLocation for controllers without one, e.g. player controllers
+		pathFollowing = NewObject<UPathFollowingComponent>(controller);
+		pathFollowing->RegisterComponentWithWorld(controller->GetWorld());
+		pathFollowing->Initialize();
+	}
+	if (!_boundFollowers.Contains(pathFollowing))
+	{
+		_boundFollowers.Add(pathFollowing);
+		pathFollowing->OnRequestFinished.AddUObject(this, &UAnchorMoveSubsystem::OnMoveFinished_Internal, TWeakObjectPtr<AController>(controller));
+	}
+	return pathFollowing;
+}
@@ -0,0 +1,88 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+
+#include "SubSystems/CharacterStatsSubsystem.h"
+#include "GameDataTypes/BaseCharacterData.h"
+#include "GameDataTypes/EnemyData.h"
+#include "GameDataTypes/CombatData.h"
+#include "UObject/UObjectIterator.h"
+
+
+void UCharacterStatsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	// The default entry, for characters without data
+	_baseStats.Add(FCharacterStats());
+	_upgrades.AddDefaulted();
+	_isEnemy.Add(false);
+	_stats.AddDefaulted();
+	CompileEntry(DefaultStatsIndex);
+}
+
+void UCharacterStatsSubsystem::CompileEntry(int32 index)
+{
+	FCharacterStatModifiers modifiers = _upgrades[index];
+	modifiers *= _isEnemy[index] ? _enemyScaling : _heroScaling;
+	const FCharacterStats& base = _baseStats[index];
+	FCompiledCharacterStats& stats = _stats[index];
+	stats.MaxHealth = base.MaxHealth * modifiers.MaxHealthMultiplier;
+	stats.WalkSpeed = base.OnGroundSpeeds.X * modifiers.SpeedMultiplier;
+	stats.RunSpeed = base.OnGroundSpeeds.Y * modifiers.SpeedMultiplier;
+	stats.SprintSpeed = base.OnGroundSpeeds.Z * modifiers.SpeedMultiplier;
+}
+
+int32 UCharacterStatsSubsystem::RegisterCharacterData(const UBaseCharacterData* Data)
+{
+	if (!Data)
+		return DefaultStatsIndex;
+	if (const int32* index = _indices.Find(Data))
+		return *index;
+	const int32 index = _stats.Num();
+	_indices.Add(Data, index);
+	_baseStats.Add(Data->Stats);
+	_upgrades.AddDefaulted();
+	_isEnemy.Add(Data->IsA<UEnemyData>());
+	_stats.AddDefaulted();
+	CompileEntry(index);
+	return index;
+}
+
+void UCharacterStatsSubsystem::CompileLoadedCharacterData()
+{
+	for (TObjectIterator<UBaseCharacterData> it; it; ++it)
+	{
+		if (!it->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+			RegisterCharacterData(*it);
+	}
+}
+
+FCompiledCharacterStats UCharacterStatsSubsystem::GetCharacterDataStats(const UBaseCharacterData* Data) const
+{
+	const int32* index = Data ? _indices.Find(Data) : nullptr;
+	return GetStats(index ? *index : DefaultStatsIndex);
+}
+
+void UCharacterStatsSubsystem::SetUpgrade(const UBaseCharacterData* Data, FCharacterStatModifiers Upgrade)
+{
+	if (!Data)
+		return;
+	const int32 index = RegisterCharacterData(Data);
+	_upgrades[index] = Upgrade;
+	CompileEntry(index);
+}
+
+void UCharacterStatsSubsystem::SetScaling(FCharacterStatModifiers HeroScaling, FCharacterStatModifiers EnemyScaling)
+{
+	_heroScaling = HeroScaling;
+	_enemyScaling = EnemyScaling;
+	for (int32 index = 0; index < _stats.Num(); index++)
+		CompileEntry(index);
+}
+
+void UCharacterStatsSubsystem::SetDifficulty(const FCombatDifficulty& Difficulty, int32 StageIndex)
+{
+	FCharacterStatModifiers enemyScaling;
+	enemyScaling.MaxHealthMultiplier = Difficulty.GetEnemyHealthMultiplier(StageIndex);
+	enemyScaling.SpeedMultiplier = Difficulty.EnemySpeedMultiplier;
+	SetScaling(FCharacterStatModifiers(), enemyScaling);
+}
@@ -1,9 +1,130 @@
 #include "SubSystems/CombatSubSystem.h"
+#include "Actors/BaseGasCharacter.h"
+#include "TimerManager.h"
 
 
 
 
 void UCombatSubSystem::SetCombatManager(ACombatManager* NewCombatManager)
 {
-	_combatManager = NewCombatManager;
+	RegisterCombatManager(NewCombatManager);
+}
+
+void UCombatSubSystem::RegisterCombatManager(ACombatManager* CombatManager)
+{
+	if (CombatManager)
+		_combatManagers.AddUnique(CombatManager);
+}
+
+void UCombatSubSystem::UnregisterCombatManager(ACombatManager* CombatManager)
+{
+	_combatManagers.Remove(CombatManager);
+	for (auto it = _actorCombats.CreateIterator(); it; ++it)
+	{
+		if (!it.Value().IsValid() || it.Value().Get() == CombatManager)
+			it.RemoveCurrent();
+	}
+}
+
+void UCombatSubSystem::RegisterCombatActor(AActor* Actor, ACombatManager* CombatManager)
+{
+	if (Actor && CombatManager)
+		_actorCombats.Add(Actor, CombatManager);
+}
+
+void UCombatSubSystem::UnregisterCombatActor(AActor* Actor)
+{
+	if (Actor)
+		_actorCombats.Remove(Actor);
+}
+
+ACombatManager* UCombatSubSystem::GetCombatOfActor(const AActor* Actor) const
+{
+	if (!Actor)
+		return nullptr;
+	const auto combat = _actorCombats.Find(Actor);
+	return combat ? combat->Get() : nullptr;
+}
+
+void UCombatSubSystem::ReportUIChange(ABaseGasCharacter* Character, float OldHealth, float NewHealth, float MaxHealth, ECombatUIChangeFlags Flags)
+{
+	if (!Character)
+		return;
+	if (const auto index = _uiChangeIndices.Find(Character))
+	{
+		auto& change = _uiChanges[*index];
+		change.NewHealth = NewHealth;
+		change.MaxHealth = MaxHealth;
+		change.Flags |= static_cast<int32>(Flags);
+		return;
+	}
+	// First change of the frame, the feed is published on the next tick
+	if (!_isUIFeedScheduled)
+	{
+		_isUIFeedScheduled = true;
+		GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UCombatSubSystem::PublishUIFeed_Internal);
+	}
+	_uiChangeIndices.Add(Character, _uiChanges.Num());
+	auto& change = _uiChanges.AddDefaulted_GetRef();
+	change.Character = Character;
+	change.OldHealth = OldHealth;
+	change.NewHealth = NewHealth;
+	change.MaxHealth = MaxHealth;
+	change.Flags = static_cast<int32>(Flags);
+}
+
+void UCombatSubSystem::PublishUIFeed_Internal()
+{
+	_isUIFeedScheduled = false;
+	// Keep both allocations, the feed is refilled every frame of a fight
+	Swap(_uiFeed, _uiChanges);
+	_uiChanges.Reset();
+	_uiChangeIndices.Reset();
+	if (_uiFeed.IsEmpty())
+		return;
+	OnCombatUIFeedNative.Broadcast(_uiFeed);
+	OnCombatUIFeed.Broadcast(_uiFeed);
+	// Publish once more to empty the feed if nothing changes next frame
+	if (!_isUIFeedScheduled)
+	{
+		_isUIFeedScheduled = true;
+		GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UCombatSubSystem::PublishUIFeed_Internal);
+	}
+}
+
+TArray<UObject*> UCombatSubSystem::FindNearestInCombat(ACombatManager* Combat, FVector Location, int32 Count, int32 Kinds, float MaxRadius)
+{
+	TArray<UObject*> results;
+	if (!Combat)
+		Combat = GetCombatManager();
+	if (Combat)
+		Combat->GetSpatialGrid().QueryNearest(Location, Count, static_cast<ECombatSpatialKind>(Kinds), results, MaxRadius);
+	return results;
+}
+
+TArray<UObject*> UCombatSubSystem::FindInCombatRadius(ACombatManager* Combat, FVector Location, float Radius, int32 Kinds)
+{
+	TArray<UObject*> results;
+	if (!Combat)
+		Combat = GetCombatManager();
+	if (Combat)
+		Combat->GetSpatialGrid().QueryRadius(Location, Radius, static_cast<ECombatSpatialKind>(Kinds), results);
+	return results;
+}
+
+TArray<UObject*> UCombatSubSystem::FindInCombatCone(ACombatManager* Combat, FVector Origin, FVector Direction, float HalfAngle, float Length, int32 Kinds)
+{
+	TArray<UObject*> results;
+	if (!Combat)
+		Combat = GetCombatManager();
+	if (Combat)
+		Combat->GetSpatialGrid().QueryCone(Origin, Direction, HalfAngle, Length, static_cast<ECombatSpatialKind>(Kinds), results);
+	return results;
+}
+
+UCharacterAnchor* UCombatSubSystem::FindFirstFreeAnchorAlongLine(ACombatManager* Combat, FVector Start, FVector End, float Radius, bool bEnemyAnchors)
+{
+	if (!Combat)
+		Combat = GetCombatManager();
+	return Combat ? Combat->FindFirstFreeAnchorAlongLine(Start, End, Radius, bEnemyAnchors) : nullptr;
 }
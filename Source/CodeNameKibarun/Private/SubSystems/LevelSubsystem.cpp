@@ -1,12 +1,42 @@
 #include "SubSystems/LevelSubsystem.h"
+#include "SubSystems/CharacterStatsSubsystem.h"
 #include <Engine/AssetManager.h>
 #include <Kismet/GameplayStatics.h>
 
+
+namespace
+{
+	// Rough memory cost of the assets held by a handle
+	int64 EstimateLoadedBytes(const TSharedPtr<FStreamableHandle>& handle)
+	{
+		int64 bytes = 0;
+		if (!handle.IsValid())
+			return bytes;
+		TArray<UObject*> loadedAssets;
+		handle->GetLoadedAssets(loadedAssets);
+		for (const auto asset : loadedAssets)
+		{
+			if (asset)
+				bytes += asset->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		}
+		return bytes;
+	}
+}
+
+
+void ULevelSubsystem::Deinitialize()
+{
+	ReleasePreloadedStages();
+	Super::Deinitialize();
+}
+
 bool ULevelSubsystem::SetLevel(ULevelData* levelDatas)
 {
 	if (!levelDatas)
 		return false;
+	ReleasePreloadedStages();
 	_stageCollection = levelDatas->Stages;
+	ApplyDifficultyScaling();
 	UKismetSystemLibrary::PrintString(this, FString::Printf(TEXT("Set level: %s"), *levelDatas->GetName()), true, false, FLinearColor::Green, 5.f);
 	return true;
 }
@@ -16,15 +46,166 @@ bool ULevelSubsystem::JumpToStage(int32 index)
 	if (!_stageCollection.Combats.IsValidIndex(index))
 		return false;
 	_stageCollection.StageIndex = index;
+	ReleasePassedStages();
+	ApplyDifficultyScaling();
 	return true;
 }
 
+void ULevelSubsystem::SetDifficulty(const FCombatDifficulty& Difficulty)
+{
+	_difficulty = Difficulty;
+	ApplyDifficultyScaling();
+}
+
+void ULevelSubsystem::ApplyDifficultyScaling()
+{
+	auto gameInstance = GetGameInstance();
+	auto statTable = gameInstance ? gameInstance->GetSubsystem<UCharacterStatsSubsystem>() : nullptr;
+	if (!statTable)
+		return;
+	statTable->SetDifficulty(_difficulty, StageIndex());
+}
+
 bool ULevelSubsystem::MoveToStage(int32 increment)
 {
 	int32 newIndex = _stageCollection.StageIndex + increment;
 	return JumpToStage(newIndex);
 }
 
+void ULevelSubsystem::PreloadUpcomingStages()
+{
+	if (_preloadingStage.IsValid())
+		return; // A stage is already on its way, it will chain the next one when done
+	auto mgr = UAssetManager::GetIfInitialized();
+	if (!mgr)
+		return;
+	const int64 budget = static_cast<int64>(PreloadMemoryBudgetMB) * 1024 * 1024;
+	for (int32 offset = 1; offset <= MaxPreloadedStages; offset++)
+	{
+		const int32 index = StageIndex() + offset;
+		if (!_stageCollection.Combats.IsValidIndex(index))
+			return;
+		const FPrimaryAssetId stageID = _stageCollection.Combats[index];
+		if (!stageID.IsValid() || _preloadedStages.Contains(stageID))
+			continue;
+		if (GetPreloadedBytes() >= budget)
+			return;
+
+		_preloadingStage = stageID;
+		_preloadedStages.Add(stageID);
+		// The delegate can be called right away if the stage is already in memory
+		auto handle = mgr->LoadPrimaryAsset(stageID, { BUNDLE_INFOS, BUNDLE_SPAWN }, FStreamableDelegate::CreateUObject(this, &ULevelSubsystem::OnStagePreloaded_Internal, stageID));
+		if (FStagePreload* preload = _preloadedStages.Find(stageID))
+		{
+			preload->StageHandle = handle;
+			// Loaded synchronously, the estimate was made before the stage handle was stored
+			if (preload->bIsLoaded)
+				preload->EstimatedBytes = EstimateLoadedBytes(preload->StageHandle) + EstimateLoadedBytes(preload->EnemiesHandle);
+			if (!handle.IsValid() && !preload->bStageLoaded)
+			{
+				// Invalid stage, don't retry it
+				_preloadingStage = FPrimaryAssetId();
+				continue;
+			}
+		}
+		return;
+	}
+}
+
+void ULevelSubsystem::OnStagePreloaded_Internal(FPrimaryAssetId stageID)
+{
+	if (_preloadingStage != stageID)
+		return; // Released while loading
+	auto mgr = UAssetManager::GetIfInitialized();
+	FStagePreload* preload = _preloadedStages.Find(stageID);
+	const auto stageData = mgr ? mgr->GetPrimaryAssetObject<UCombatData>(stageID) : nullptr;
+	if (!preload || !stageData)
+	{
+		_preloadedStages.Remove(stageID);
+		_preloadingStage = FPrimaryAssetId();
+		return;
+	}
+	preload->bStageLoaded = true;
+
+	// Then the enemies of the first wave, so the first spawn doesn't wait on the disk
+	TArray<FPrimaryAssetId> enemies;
+	for (const auto& enemy : stageData->GetWaveSchedule().GetWaveEnemies(0))
+		enemies.AddUnique(enemy);
+	TSharedPtr<FStreamableHandle> enemiesHandle;
+	if (!enemies.IsEmpty())
+		enemiesHandle = mgr->LoadPrimaryAssets(enemies, { BUNDLE_SPAWN }, FStreamableDelegate::CreateUObject(this, &ULevelSubsystem::OnStageEnemiesPreloaded_Internal, stageID));
+	preload = _preloadedStages.Find(stageID);
+	if (!preload)
+		return;
+	preload->EnemiesHandle = enemiesHandle;
+	if (!enemiesHandle.IsValid() && !preload->bIsLoaded)
+		OnStageEnemiesPreloaded_Internal(stageID);
+}
+
+void ULevelSubsystem::OnStageEnemiesPreloaded_Internal(FPrimaryAssetId stageID)
+{
+	if (_preloadingStage != stageID)
+		return; // Released while loading
+	if (FStagePreload* preload = _preloadedStages.Find(stageID))
+	{
+		preload->bIsLoaded = true;
+		preload->EstimatedBytes = EstimateLoadedBytes(preload->StageHandle) + EstimateLoadedBytes(preload->EnemiesHandle);
+	}
+	_preloadingStage = FPrimaryAssetId();
+
+	// Go further ahead if the budget allows it
+	PreloadUpcomingStages();
+}
+
+UCombatData* ULevelSubsystem::GetPreloadedStage(FPrimaryAssetId stageID) const
+{
+	const FStagePreload* preload = _preloadedStages.Find(stageID);
+	if (!preload || !preload->bIsLoaded)
+		return nullptr;
+	auto mgr = UAssetManager::GetIfInitialized();
+	return mgr ? mgr->GetPrimaryAssetObject<UCombatData>(stageID) : nullptr;
+}
+
+int64 ULevelSubsystem::GetPreloadedBytes() const
+{
+	int64 bytes = 0;
+	for (const auto& preload : _preloadedStages)
+		bytes += preload.Value.EstimatedBytes;
+	return bytes;
+}
+
+void ULevelSubsystem::ReleasePassedStages()
+{
+	TSet<FPrimaryAssetId> upcomingStages;
+	for (int32 i = StageIndex(); i < _stageCollection.Combats.Num(); i++)
+		upcomingStages.Add(_stageCollection.Combats[i]);
+	for (auto it = _preloadedStages.CreateIterator(); it; ++it)
+	{
+		if (upcomingStages.Contains(it.Key()))
+			continue;
+		if (it.Value().StageHandle.IsValid())
+			it.Value().StageHandle->ReleaseHandle();
+		if (it.Value().EnemiesHandle.IsValid())
+			it.Value().EnemiesHandle->ReleaseHandle();
+		if (_preloadingStage == it.Key())
+			_preloadingStage = FPrimaryAssetId();
+		it.RemoveCurrent();
+	}
+}
+
+void ULevelSubsystem::ReleasePreloadedStages()
+{
+	for (auto& preload : _preloadedStages)
+	{
+		if (preload.Value.StageHandle.IsValid())
+			preload.Value.StageHandle->ReleaseHandle();
+		if (preload.Value.EnemiesHandle.IsValid())
+			preload.Value.EnemiesHandle->ReleaseHandle();
+	}
+	_preloadedStages.Empty();
+	_preloadingStage = FPrimaryAssetId();
+}
+
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
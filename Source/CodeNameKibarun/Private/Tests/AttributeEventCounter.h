@@ -0,0 +1,30 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "AttributeEventCounter.generated.h"
+
+
+/**
+ * Counts the Blueprint attribute events it is bound to, for the automation tests
+ */
+UCLASS(Transient, NotBlueprintable)
+class UAttributeEventCounter : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	int32 Count = 0;
+
+	float LastChangeDelta = 0;
+
+	UFUNCTION()
+	void OnAttributeChanged(float ChangeDelta, float NewValue, bool HitLimit)
+	{
+		Count++;
+		LastChangeDelta = ChangeDelta;
+	}
+};
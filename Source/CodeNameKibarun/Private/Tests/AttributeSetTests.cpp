@@ -0,0 +1,216 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Tests/AttributeEventCounter.h"
+#include "AbilitySystem/Attributes/CommonCharacterAttributeSet.h"
+#include "AbilitySystemComponent.h"
+#include "GameplayEffect.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "HAL/IConsoleManager.h"
+
+
+static TAutoConsoleVariable<int32> CVarAttributeBenchmarkCharacters(
+	TEXT("Kibarun.Combat.AttributeBenchmark.Characters"),
+	256,
+	TEXT("How many characters take periodic damage in the Kibarun.Combat.Attributes.BroadcastBenchmark test"),
+	ECVF_Default);
+
+
+namespace
+{
+	// Periodic damage of one point, applied on the first execution too
+	UGameplayEffect* MakePeriodicDamage(float period)
+	{
+		UGameplayEffect* effect = NewObject<UGameplayEffect>(GetTransientPackage(), MakeUniqueObjectName(GetTransientPackage(), UGameplayEffect::StaticClass(), TEXT("PeriodicDamage")));
+		effect->DurationPolicy = EGameplayEffectDurationType::Infinite;
+		effect->Period = FScalableFloat(period);
+		effect->bExecutePeriodicEffectOnApplication = true;
+		FGameplayModifierInfo& damage = effect->Modifiers.AddDefaulted_GetRef();
+		damage.Attribute = UCommonCharacterAttributeSet::GetHealthAttribute();
+		damage.ModifierOp = EGameplayModOp::Additive;
+		damage.ModifierMagnitude = FGameplayEffectModifierMagnitude(FScalableFloat(-1.f));
+		return effect;
+	}
+
+	// An actor with an ability system and the common attribute set, at high health
+	UAbilitySystemComponent* SpawnAttributeActor(UWorld* world, UCommonCharacterAttributeSet*& outAttributes)
+	{
+		AActor* actor = world->SpawnActor<AActor>();
+		auto abilitySystem = NewObject<UAbilitySystemComponent>(actor);
+		abilitySystem->RegisterComponent();
+		abilitySystem->InitAbilityActorInfo(actor, actor);
+		outAttributes = NewObject<UCommonCharacterAttributeSet>(actor);
+		abilitySystem->AddAttributeSetSubobject(outAttributes);
+		abilitySystem->SetNumericAttributeBase(UCommonCharacterAttributeSet::GetMaxHealthAttribute(), 1000000);
+		abilitySystem->SetNumericAttributeBase(UCommonCharacterAttributeSet::GetHealthAttribute(), 1000000);
+		return abilitySystem;
+	}
+
+	UWorld* CreateTestWorld(const TCHAR* name)
+	{
+		UWorld* world = UWorld::CreateWorld(EWorldType::Game, false, name);
+		FWorldContext& context = GEngine->CreateNewWorldContext(EWorldType::Game);
+		context.SetCurrentWorld(world);
+		world->InitializeActorsForPlay(FURL());
+		world->BeginPlay();
+		return world;
+	}
+
+	void DestroyTestWorld(UWorld* world)
+	{
+		GEngine->DestroyWorldContext(world);
+		world->DestroyWorld(false);
+	}
+}
+
+
+// Periodic damage on many attribute sets, executed several times per frame: each set must fire its Blueprint event once per frame
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAttributeBroadcastOncePerFrameTest, "Kibarun.Combat.Attributes.BroadcastOncePerFrame", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FAttributeBroadcastOncePerFrameTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 SetCount = 16;
+	constexpr int32 ApplicationsPerSet = 3;
+	constexpr int32 Frames = 5;
+	constexpr float FrameTime = 0.1f;
+	constexpr float Period = 0.03f;
+
+	UWorld* world = CreateTestWorld(TEXT("AttributeBroadcastTest"));
+	UGameplayEffect* effect = MakePeriodicDamage(Period);
+
+	TArray<UAbilitySystemComponent*> systems;
+	TArray<UAttributeEventCounter*> counters;
+	for (int32 i = 0; i < SetCount; i++)
+	{
+		UCommonCharacterAttributeSet* attributes = nullptr;
+		auto abilitySystem = SpawnAttributeActor(world, attributes);
+		auto counter = NewObject<UAttributeEventCounter>(GetTransientPackage());
+		counter->AddToRoot();
+		attributes->OnHealthChanged.AddDynamic(counter, &UAttributeEventCounter::OnAttributeChanged);
+		systems.Add(abilitySystem);
+		counters.Add(counter);
+	}
+
+	// Several executions within the same frame
+	for (auto abilitySystem : systems)
+		for (int32 n = 0; n < ApplicationsPerSet; n++)
+			abilitySystem->ApplyGameplayEffectToSelf(effect, 1.f, abilitySystem->MakeEffectContext());
+	for (int32 i = 0; i < SetCount; i++)
+		TestEqual(TEXT("No broadcast before the next tick"), counters[i]->Count, 0);
+
+	// Timers only tick once per engine frame
+	GFrameCounter++;
+	world->GetTimerManager().Tick(FrameTime);
+	for (int32 i = 0; i < SetCount; i++)
+	{
+		TestEqual(FString::Printf(TEXT("Set %d broadcast once for the applications"), i), counters[i]->Count, 1);
+		TestEqual(FString::Printf(TEXT("Set %d broadcast the summed change"), i), counters[i]->LastChangeDelta, -static_cast<float>(ApplicationsPerSet));
+	}
+
+	// Every frame runs several periods of every application, and flushes the previous frame changes
+	for (int32 frame = 0; frame < Frames; frame++)
+	{
+		TArray<int32> countsBefore;
+		for (auto counter : counters)
+			countsBefore.Add(counter->Count);
+		GFrameCounter++;
+		world->GetTimerManager().Tick(FrameTime);
+		for (int32 i = 0; i < SetCount; i++)
+			TestEqual(FString::Printf(TEXT("Set %d broadcast once on frame %d"), i, frame), counters[i]->Count - countsBefore[i], 1);
+	}
+
+	for (auto counter : counters)
+		counter->RemoveFromRoot();
+	DestroyTestWorld(world);
+	return true;
+}
+
+
+namespace
+{
+	constexpr int32 BenchmarkFrames = 60;
+
+	struct FAttributeBenchmarkResult
+	{
+		double Seconds = 0;
+		int32 Broadcasts = 0;
+	};
+
+	// N characters under periodic damage for a few frames. Per effect, every execution fires a dynamic event like before the
+	// coalescing. Coalesced, the attribute set queues the executions and fires its Blueprint event once per frame
+	FAttributeBenchmarkResult RunAttributeBenchmark(int32 characterCount, bool bCoalesced)
+	{
+		constexpr int32 ApplicationsPerCharacter = 4;
+		constexpr float FrameTime = 1.f / 30.f;
+		constexpr float Period = 0.01f;
+
+		UWorld* world = CreateTestWorld(bCoalesced ? TEXT("AttributeBenchmarkCoalesced") : TEXT("AttributeBenchmarkPerEffect"));
+		UGameplayEffect* effect = MakePeriodicDamage(Period);
+		auto counter = NewObject<UAttributeEventCounter>(GetTransientPackage());
+		counter->AddToRoot();
+		// Stable addresses, the value change delegates point to them
+		TArray<FBaseAttributeEvent> perEffectEvents;
+		perEffectEvents.SetNum(characterCount);
+		TArray<UAbilitySystemComponent*> systems;
+		for (int32 i = 0; i < characterCount; i++)
+		{
+			UCommonCharacterAttributeSet* attributes = nullptr;
+			auto abilitySystem = SpawnAttributeActor(world, attributes);
+			if (bCoalesced)
+			{
+				attributes->OnHealthChanged.AddDynamic(counter, &UAttributeEventCounter::OnAttributeChanged);
+			}
+			else
+			{
+				FBaseAttributeEvent* event = &perEffectEvents[i];
+				event->AddDynamic(counter, &UAttributeEventCounter::OnAttributeChanged);
+				abilitySystem->GetGameplayAttributeValueChangeDelegate(UCommonCharacterAttributeSet::GetHealthAttribute())
+					.AddLambda([event](const FOnAttributeChangeData& data) { event->Broadcast(data.NewValue - data.OldValue, data.NewValue, false); });
+			}
+			systems.Add(abilitySystem);
+		}
+
+		const double startTime = FPlatformTime::Seconds();
+		for (auto abilitySystem : systems)
+			for (int32 n = 0; n < ApplicationsPerCharacter; n++)
+				abilitySystem->ApplyGameplayEffectToSelf(effect, 1.f, abilitySystem->MakeEffectContext());
+		for (int32 frame = 0; frame < BenchmarkFrames; frame++)
+		{
+			GFrameCounter++;
+			world->GetTimerManager().Tick(FrameTime);
+		}
+		FAttributeBenchmarkResult result;
+		result.Seconds = FPlatformTime::Seconds() - startTime;
+		result.Broadcasts = counter->Count;
+
+		counter->RemoveFromRoot();
+		DestroyTestWorld(world);
+		return result;
+	}
+}
+
+
+// Cost of the health events with N characters under periodic damage, firing per effect against coalescing per frame.
+// Set the character count with Kibarun.Combat.AttributeBenchmark.Characters
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAttributeBroadcastBenchmarkTest, "Kibarun.Combat.Attributes.BroadcastBenchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+bool FAttributeBroadcastBenchmarkTest::RunTest(const FString& Parameters)
+{
+	const int32 characterCount = FMath::Max(1, CVarAttributeBenchmarkCharacters.GetValueOnGameThread());
+	const FAttributeBenchmarkResult perEffect = RunAttributeBenchmark(characterCount, false);
+	const FAttributeBenchmarkResult coalesced = RunAttributeBenchmark(characterCount, true);
+
+	AddInfo(FString::Printf(TEXT("%d characters, per effect: %.2f ms for %d broadcasts"), characterCount, perEffect.Seconds * 1000, perEffect.Broadcasts));
+	AddInfo(FString::Printf(TEXT("%d characters, coalesced: %.2f ms for %d broadcasts"), characterCount, coalesced.Seconds * 1000, coalesced.Broadcasts));
+	AddInfo(FString::Printf(TEXT("Coalesced runs in %.0f%% of the per effect time"), perEffect.Seconds > 0 ? 100 * coalesced.Seconds / perEffect.Seconds : 0));
+	// Timings depend on the machine, only the broadcast counts are checked
+	TestTrue(TEXT("Several executions per frame"), perEffect.Broadcasts > coalesced.Broadcasts);
+	TestTrue(TEXT("At most one coalesced broadcast per character and frame"), coalesced.Broadcasts <= characterCount * BenchmarkFrames);
+	return true;
+}
+
+#endif
@@ -0,0 +1,125 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Tests/AutomationCommon.h"
+#include "Serialization/BitWriter.h"
+#include "Serialization/BitReader.h"
+#include "Combat/CombatReplication.h"
+#include "Actors/CombatManager.h"
+#include "SubSystems/CombatSubSystem.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+
+namespace
+{
+	// Sampling window and budget of the bandwidth test, per combat and per client
+	constexpr double BandwidthSampleSeconds = 5;
+	constexpr double MaxCombatBytesPerSecondPerClient = 1024;
+
+	// The PIE server worlds, with the count of PIE clients next to them
+	TArray<UWorld*> FindPIEServerWorlds(int32& clientCount)
+	{
+		TArray<UWorld*> servers;
+		clientCount = 0;
+		if (!GEngine)
+			return servers;
+		for (const FWorldContext& context : GEngine->GetWorldContexts())
+		{
+			UWorld* world = context.World();
+			if (!world || context.WorldType != EWorldType::PIE)
+				continue;
+			const ENetMode netMode = world->GetNetMode();
+			if (netMode == NM_Client)
+				clientCount++;
+			else if (netMode == NM_ListenServer || netMode == NM_DedicatedServer)
+				servers.Add(world);
+		}
+		return servers;
+	}
+}
+
+
+DEFINE_LATENT_AUTOMATION_COMMAND(FResetCombatNetStatsCommand);
+bool FResetCombatNetStatsCommand::Update()
+{
+	int32 clientCount = 0;
+	for (UWorld* world : FindPIEServerWorlds(clientCount))
+	{
+		if (auto subSys = world->GetSubsystem<UCombatSubSystem>())
+			for (auto combat : subSys->GetCombatManagers())
+				if (combat)
+					combat->GetNetStats().Reset(world->GetTimeSeconds());
+	}
+	return true;
+}
+
+DEFINE_LATENT_AUTOMATION_COMMAND_ONE_PARAMETER(FCheckCombatNetStatsCommand, FAutomationTestBase*, Test);
+bool FCheckCombatNetStatsCommand::Update()
+{
+	int32 clientCount = 0;
+	for (UWorld* world : FindPIEServerWorlds(clientCount))
+	{
+		auto subSys = world->GetSubsystem<UCombatSubSystem>();
+		if (!subSys)
+			continue;
+		for (auto combat : subSys->GetCombatManagers())
+		{
+			if (!combat)
+				continue;
+			// Every client connection serializes its own copy, the counter holds them all
+			const double bytesPerSecond = combat->GetNetStats().GetBytesPerSecond(world->GetTimeSeconds());
+			const double perClient = bytesPerSecond / FMath::Max(clientCount, 1);
+			Test->AddInfo(FString::Printf(TEXT("%s: %.1f bytes/sec, %.1f per client (%d clients)"), *combat->GetName(), bytesPerSecond, perClient, clientCount));
+			Test->TestTrue(FString::Printf(TEXT("%s stays under %.0f bytes/sec per client"), *combat->GetName(), MaxCombatBytesPerSecondPerClient), perClient <= MaxCombatBytesPerSecondPerClient);
+		}
+	}
+	return true;
+}
+
+
+// Measure the replicated combat state of a running multi-client PIE session (Play As Listen Server, 2+ players).
+// Manual test: it needs the session started by hand, so it is kept out of the automated runs and fails without one
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCombatReplicationBandwidthTest, "Kibarun.Combat.Replication.BytesPerSecond", EAutomationTestFlags::EditorContext | EAutomationTestFlags::RequiresUser | EAutomationTestFlags::ProductFilter)
+bool FCombatReplicationBandwidthTest::RunTest(const FString& Parameters)
+{
+	int32 clientCount = 0;
+	if (FindPIEServerWorlds(clientCount).IsEmpty() || clientCount == 0)
+	{
+		AddError(TEXT("No multi-client PIE session running. Start Play In Editor as Listen Server with 2+ players, then run this test"));
+		return false;
+	}
+	ADD_LATENT_AUTOMATION_COMMAND(FResetCombatNetStatsCommand());
+	ADD_LATENT_AUTOMATION_COMMAND(FEngineWaitLatentCommand(BandwidthSampleSeconds));
+	ADD_LATENT_AUTOMATION_COMMAND(FCheckCombatNetStatsCommand(this));
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCombatCursorPackingTest, "Kibarun.Combat.Replication.CursorPacking", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+bool FCombatCursorPackingTest::RunTest(const FString& Parameters)
+{
+	FReplicatedCombatCursor cursor;
+	cursor.Phase = 3;
+	cursor.bHasBeganSpawn = true;
+	cursor.WaveIndex = 17;
+	cursor.EnemyIndex = 300;
+
+	bool bSuccess = false;
+	FBitWriter writer(0, true);
+	cursor.NetSerialize(writer, nullptr, bSuccess);
+	TestTrue(TEXT("Cursor written"), bSuccess);
+	TestTrue(TEXT("Cursor fits in 4 bytes"), writer.GetNumBytes() <= 4);
+
+	FBitReader reader(writer.GetData(), writer.GetNumBits());
+	FReplicatedCombatCursor read;
+	read.NetSerialize(reader, nullptr, bSuccess);
+	TestTrue(TEXT("Cursor read back"), bSuccess && read == cursor);
+	return true;
+}
+
+#endif
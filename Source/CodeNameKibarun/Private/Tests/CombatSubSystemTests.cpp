@@ -0,0 +1,239 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Tests/TestCombatCharacter.h"
+#include "SubSystems/CombatSubSystem.h"
+#include "Actors/CombatManager.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+
+
+// Several combats in the same world, each with its actors: the registry answers which combat owns an actor
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCombatRegistryTest, "Kibarun.Combat.SubSystem.Registry", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FCombatRegistryTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 CombatCount = 3;
+	constexpr int32 ActorsPerCombat = 4;
+
+	// Not begun, the managers don't register nor load anything by themselves
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false, TEXT("CombatRegistryTest"));
+	FWorldContext& context = GEngine->CreateNewWorldContext(EWorldType::Game);
+	context.SetCurrentWorld(world);
+	UCombatSubSystem* subSys = world->GetSubsystem<UCombatSubSystem>();
+	if (!TestNotNull(TEXT("Combat subsystem"), subSys))
+	{
+		GEngine->DestroyWorldContext(world);
+		world->DestroyWorld(false);
+		return false;
+	}
+
+	TArray<ACombatManager*> combats;
+	TArray<TArray<AActor*>> combatActors;
+	for (int32 i = 0; i < CombatCount; i++)
+	{
+		auto combat = world->SpawnActor<ACombatManager>();
+		subSys->RegisterCombatManager(combat);
+		combats.Add(combat);
+		TArray<AActor*>& actors = combatActors.AddDefaulted_GetRef();
+		for (int32 n = 0; n < ActorsPerCombat; n++)
+		{
+			AActor* actor = world->SpawnActor<AActor>();
+			subSys->RegisterCombatActor(actor, combat);
+			actors.Add(actor);
+		}
+	}
+	AActor* outsider = world->SpawnActor<AActor>();
+
+	TestEqual(TEXT("Every combat is registered"), subSys->GetCombatManagers().Num(), CombatCount);
+	TestTrue(TEXT("The first combat is the default one"), subSys->GetCombatManager() == combats[0]);
+	for (int32 i = 0; i < CombatCount; i++)
+		for (AActor* actor : combatActors[i])
+			TestTrue(FString::Printf(TEXT("Actor of combat %d"), i), subSys->GetCombatOfActor(actor) == combats[i]);
+	TestNull(TEXT("Unregistered actor"), subSys->GetCombatOfActor(outsider));
+	TestNull(TEXT("No actor"), subSys->GetCombatOfActor(nullptr));
+
+	// An actor leaving its combat
+	subSys->UnregisterCombatActor(combatActors[0][0]);
+	TestNull(TEXT("Actor unregistered"), subSys->GetCombatOfActor(combatActors[0][0]));
+	TestTrue(TEXT("Its neighbours stay"), subSys->GetCombatOfActor(combatActors[0][1]) == combats[0]);
+
+	// A combat leaving takes its actors along, the others are untouched
+	subSys->UnregisterCombatManager(combats[1]);
+	TestEqual(TEXT("Combat unregistered"), subSys->GetCombatManagers().Num(), CombatCount - 1);
+	TestFalse(TEXT("Combat removed from the list"), subSys->GetCombatManagers().Contains(combats[1]));
+	for (AActor* actor : combatActors[1])
+		TestNull(TEXT("Actor of the unregistered combat"), subSys->GetCombatOfActor(actor));
+	for (AActor* actor : combatActors[2])
+		TestTrue(TEXT("Actor of another combat"), subSys->GetCombatOfActor(actor) == combats[2]);
+
+	GEngine->DestroyWorldContext(world);
+	world->DestroyWorld(false);
+	return true;
+}
+
+
+// Dozens of begun combats side by side, each with its player and live characters spawning and dying every frame.
+// Every character must stay owned by its combat until it leaves, and every combat must drive its own player camera
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FConcurrentCombatsStressTest, "Kibarun.Combat.SubSystem.ConcurrentCombats", EAutomationTestFlags::EditorContext | EAutomationTestFlags::StressFilter)
+bool FConcurrentCombatsStressTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 CombatCount = 48;
+	constexpr int32 EnemiesPerCombat = 16;
+	constexpr int32 Rounds = 10;
+	constexpr float FrameTime = 1.f / 30.f;
+	constexpr float CombatSpacing = 10000.f;
+
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false, TEXT("ConcurrentCombatsTest"));
+	FWorldContext& context = GEngine->CreateNewWorldContext(EWorldType::Game);
+	context.SetCurrentWorld(world);
+	auto tickFrame = [world]()
+	{
+		// Timers only tick once per engine frame
+		GFrameCounter++;
+		world->GetTimerManager().Tick(FrameTime);
+	};
+
+	// One player per combat, each combat routed to its own
+	TArray<APlayerController*> players;
+	TArray<ACombatManager*> combats;
+	for (int32 i = 0; i < CombatCount; i++)
+	{
+		players.Add(world->SpawnActor<APlayerController>());
+		const FTransform combatTransform(FVector(i * CombatSpacing, 0, 0));
+		auto combat = world->SpawnActorDeferred<ACombatManager>(ACombatManager::StaticClass(), combatTransform);
+		combat->AutoInitCombat = false;
+		combat->PlayerIndex = i;
+		combat->CameraBlendTime = 0;
+		combat->DeadDespawnDelay = 0;
+		combat->bUseEnemyProxies = false;
+		combat->FinishSpawning(combatTransform);
+		combats.Add(combat);
+	}
+	// The managers register themselves on BeginPlay
+	world->InitializeActorsForPlay(FURL());
+	world->BeginPlay();
+	UCombatSubSystem* subSys = world->GetSubsystem<UCombatSubSystem>();
+	if (!TestNotNull(TEXT("Combat subsystem"), subSys) || !TestEqual(TEXT("Every combat is registered"), subSys->GetCombatManagers().Num(), CombatCount))
+	{
+		GEngine->DestroyWorldContext(world);
+		world->DestroyWorld(false);
+		return false;
+	}
+
+	// Live characters in every combat
+	TArray<ABaseGasCharacter*> heroes;
+	int32 spawnedEnemies = 0;
+	FActorSpawnParameters spawnParameters;
+	spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	auto spawnCharacter = [world, &spawnParameters](ACombatManager* combat)
+	{
+		return world->SpawnActor<ATestCombatCharacter>(combat->GetActorLocation() + FVector(0, 0, 200), FRotator::ZeroRotator, spawnParameters);
+	};
+	for (ACombatManager* combat : combats)
+	{
+		ABaseGasCharacter* hero = spawnCharacter(combat);
+		combat->AddHeroToCombat(hero);
+		heroes.Add(hero);
+		for (int32 n = 0; n < EnemiesPerCombat; n++)
+			combat->AddEnemyToCombat(spawnCharacter(combat), FPrimaryAssetId());
+		spawnedEnemies += EnemiesPerCombat;
+		combat->BeginCombat();
+	}
+	tickFrame();
+
+	// Each combat drives the camera of its own player
+	for (int32 i = 0; i < CombatCount; i++)
+	{
+		TestTrue(FString::Printf(TEXT("Combat %d routes to its player"), i), combats[i]->GetCombatPlayerController() == players[i]);
+		TestTrue(FString::Printf(TEXT("Combat %d moved the camera of its player"), i), players[i]->GetViewTarget() == combats[i]);
+		TestEqual(FString::Printf(TEXT("Combat %d began"), i), combats[i]->GetCombatPhase(), ECombatPhase::Active);
+	}
+
+	auto checkOwnership = [&](const TCHAR* step, int32 firstCombat)
+	{
+		for (int32 i = firstCombat; i < CombatCount; i++)
+		{
+			for (ABaseGasCharacter* enemy : combats[i]->GetEnemiesInScene())
+				if (subSys->GetCombatOfActor(enemy) != combats[i])
+					AddError(FString::Printf(TEXT("%s: enemy %s of combat %d owned by another combat"), step, *GetNameSafe(enemy), i));
+			for (ABaseGasCharacter* hero : combats[i]->GetHeroesInScene())
+				if (subSys->GetCombatOfActor(hero) != combats[i])
+					AddError(FString::Printf(TEXT("%s: hero %s of combat %d owned by another combat"), step, *GetNameSafe(hero), i));
+		}
+	};
+	checkOwnership(TEXT("Begin"), 0);
+
+	// Every round, each combat loses two enemies and gets one new, while the others keep going
+	for (int32 round = 0; round < Rounds; round++)
+	{
+		TArray<ABaseGasCharacter*> dead;
+		for (int32 i = 0; i < CombatCount; i++)
+		{
+			const auto& enemies = combats[i]->GetEnemiesInScene();
+			for (int32 n = 0; n < 2 && n < enemies.Num(); n++)
+				dead.Add(enemies[n]);
+			combats[i]->AddEnemyToCombat(spawnCharacter(combats[i]), FPrimaryAssetId());
+			spawnedEnemies++;
+		}
+		for (ABaseGasCharacter* character : dead)
+			character->Die();
+		// Deaths are flushed on the next tick, then despawned right away
+		tickFrame();
+		for (ABaseGasCharacter* character : dead)
+		{
+			if (!character->IsActorBeingDestroyed())
+				AddError(FString::Printf(TEXT("Round %d: dead enemy %s not despawned"), round, *character->GetName()));
+			if (subSys->GetCombatOfActor(character))
+				AddError(FString::Printf(TEXT("Round %d: dead enemy %s still owned by a combat"), round, *character->GetName()));
+		}
+		checkOwnership(*FString::Printf(TEXT("Round %d"), round), 0);
+	}
+	int32 aliveEnemies = 0;
+	for (ACombatManager* combat : combats)
+		aliveEnemies += combat->GetEnemiesInScene().Num();
+	AddInfo(FString::Printf(TEXT("%d combats, %d enemies spawned, %d still alive"), CombatCount, spawnedEnemies, aliveEnemies));
+	TestEqual(TEXT("Each combat kept its live enemies"), aliveEnemies, CombatCount * (EnemiesPerCombat - Rounds));
+
+	// Heroes leaving half of the combats, the other combats keep theirs
+	for (int32 i = 0; i < CombatCount; i += 2)
+		heroes[i]->Destroy();
+	for (int32 i = 0; i < CombatCount; i++)
+	{
+		ABaseGasCharacter* hero = heroes[i];
+		if (i % 2 == 0)
+		{
+			TestTrue(FString::Printf(TEXT("Hero of combat %d left its roster"), i), combats[i]->GetHeroesInScene().IsEmpty());
+			TestNull(FString::Printf(TEXT("Hero of combat %d unregistered"), i), subSys->GetCombatOfActor(hero));
+		}
+		else
+		{
+			TestTrue(FString::Printf(TEXT("Hero of combat %d still owned"), i), subSys->GetCombatOfActor(hero) == combats[i]);
+		}
+	}
+
+	// Combats ending one after the other take their characters along, and only theirs
+	for (int32 i = 0; i < CombatCount / 2; i++)
+	{
+		TArray<ABaseGasCharacter*> enemies = ObjectPtrDecay(combats[i]->GetEnemiesInScene());
+		combats[i]->Destroy();
+		for (ABaseGasCharacter* enemy : enemies)
+			if (subSys->GetCombatOfActor(enemy))
+				AddError(FString::Printf(TEXT("Enemy %s still owned after its combat ended"), *GetNameSafe(enemy)));
+	}
+	TestEqual(TEXT("Ended combats unregistered"), subSys->GetCombatManagers().Num(), CombatCount - CombatCount / 2);
+	for (int32 i = CombatCount / 2; i < CombatCount; i++)
+		TestTrue(FString::Printf(TEXT("Combat %d still routes to its player"), i), combats[i]->GetCombatPlayerController() == players[i]);
+	checkOwnership(TEXT("End"), CombatCount / 2);
+
+	GEngine->DestroyWorldContext(world);
+	world->DestroyWorld(false);
+	return true;
+}
+
+#endif
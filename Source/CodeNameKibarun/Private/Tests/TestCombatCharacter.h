@@ -0,0 +1,17 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Actors/BaseGasCharacter.h"
+#include "TestCombatCharacter.generated.h"
+
+
+/**
+ * Concrete character without data, spawned by the automation tests in place of the Blueprint heroes and enemies
+ */
+UCLASS(Transient, NotBlueprintable)
+class ATestCombatCharacter : public ABaseGasCharacter
+{
+	GENERATED_BODY()
+};
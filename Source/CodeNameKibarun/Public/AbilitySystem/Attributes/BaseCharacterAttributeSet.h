@@ -18,6 +18,21 @@
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FBaseAttributeEvent, float, ChangeDelta, float, NewValue, bool, HitLimit);
 
 
+/**
+ * The changes of an attribute since the last flush, summed
+ */
+struct FPendingAttributeChange
+{
+	FGameplayAttribute Attribute;
+
+	float ChangeDelta = 0;
+
+	float NewValue = 0;
+
+	bool HitLimit = false;
+};
+
+
 /**
  * The Root of all character Gas Attributes
  */
@@ -25,5 +40,19 @@ UCLASS(Abstract)
 class CODENAMEKIBARUN_API UBaseCharacterAttributeSet : public UAttributeSet
 {
 	GENERATED_BODY()
-	
+
+private:
+
+	// Few attributes per set, a linear search beats a map
+	TArray<FPendingAttributeChange, TInlineAllocator<4>> _pendingChanges;
+
+	void FlushAttributeChanges_Internal();
+
+protected:
+
+	// Coalesce a change, BroadcastAttributeChange is called once for the attribute on the next tick
+	void QueueAttributeChange(const FGameplayAttribute& Attribute, float ChangeDelta, float NewValue, bool HitLimit);
+
+	// Fire the Blueprint event of the attribute
+	virtual void BroadcastAttributeChange(const FPendingAttributeChange& Change) {}
 };
@@ -19,25 +19,54 @@ public:
 
 	void PostGameplayEffectExecute(const FGameplayEffectModCallbackData& Data) override;
 
+	void PreAttributeChange(const FGameplayAttribute& Attribute, float& NewValue) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+protected:
+
+	virtual void BroadcastAttributeChange(const FPendingAttributeChange& Change) override;
+
+public:
+
 
 	// Max Health _________________________________________________________________
 	
+	// Fired at most once per frame, with the summed change. Native code listens to the ability system value change delegates instead
 	UPROPERTY(BlueprintAssignable)
 	FBaseAttributeEvent OnMaxHealthChanged;
 	
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_MaxHealth)
 	FGameplayAttributeData MaxHealth;
 	
 	BASE_ATTRIBUTE_ACCESSORS(UCommonCharacterAttributeSet, MaxHealth);
 
+	UFUNCTION()
+	void OnRep_MaxHealth(const FGameplayAttributeData& OldValue);
+
 	// Health _________________________________________________________________
 	
+	// Fired at most once per frame, with the summed change
 	UPROPERTY(BlueprintAssignable)
 	FBaseAttributeEvent OnHealthChanged;
 	
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_Health)
 	FGameplayAttributeData Health;
 	
 	BASE_ATTRIBUTE_ACCESSORS(UCommonCharacterAttributeSet, Health);
+
+	UFUNCTION()
+	void OnRep_Health(const FGameplayAttributeData& OldValue);
+
+	// Move Speed _________________________________________________________________
+
+	// Scales the speed of the character speed mode. Slows and hastes are gameplay effects modifying it
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_MoveSpeedMultiplier)
+	FGameplayAttributeData MoveSpeedMultiplier = 1.f;
+
+	BASE_ATTRIBUTE_ACCESSORS(UCommonCharacterAttributeSet, MoveSpeedMultiplier);
+
+	UFUNCTION()
+	void OnRep_MoveSpeedMultiplier(const FGameplayAttributeData& OldValue);
 	
 };
@@ -8,10 +8,9 @@
 #include "AbilitySystemComponent.h"
 #include "AbilitySystem/Attributes/CommonCharacterAttributeSet.h"
 #include "GameDataTypes/BaseCharacterData.h"
+#include "SubSystems/CharacterStatsSubsystem.h"
 #include "Camera/CameraComponent.h"
-#include "FCTween.h"
-#include "FCTweenInstance.h"
-#include "FCTweenUObject.h"
+#include "FCEasing.h"
 #include "BaseGasCharacter.generated.h"
 
 
@@ -26,6 +25,22 @@ enum class EMoveToAnchorType : uint8
 	Teleport
 };
 
+UENUM(BlueprintType)
+enum class ECharacterSpeedMode : uint8
+{
+	Walk,
+	Run,
+	Sprint
+};
+
+UENUM(BlueprintType)
+enum class ECombatSignificance : uint8
+{
+	High UMETA(ToolTip = "Updated every frame"),
+	Medium UMETA(ToolTip = "Movement and animation updated at a reduced rate"),
+	Low UMETA(ToolTip = "Movement and animation updated at a low rate"),
+};
+
 
 class UCharacterAnchor;
 class ABaseGasCharacter;
@@ -54,9 +69,28 @@ private:
 	// Active when the character is moving to an anchor
 	EMoveToAnchorType _movingToAnchorType = EMoveToAnchorType::None;
 
-	//UPROPERTY()
-	UFCTweenUObject* _dashTween;
-	FCTweenInstanceVector* _dashTweenVector;
+	// Set once, the first time health reaches 0
+	bool _isDead = false;
+
+	ECombatSignificance _significance = ECombatSignificance::High;
+
+	// The character stats, an entry of the stat table set at BeginPlay
+	UPROPERTY(Transient)
+	TObjectPtr<UCharacterStatsSubsystem> _statTable;
+	int32 _statIndex = UCharacterStatsSubsystem::DefaultStatsIndex;
+
+	// The speed mode was changed, MaxWalkSpeed is updated on the next tick
+	bool _isSpeedDirty = false;
+
+	void ApplySpeed_Internal();
+
+	void OnMoveSpeedMultiplierChanged_Internal(const FOnAttributeChangeData& Data);
+
+	// Root motion source of the running dash, and the timer ending it
+	uint16 _dashRootMotionID = 0;
+	FTimerHandle _dashTimerHandle;
+
+	void OnDashEnded_Internal();
 
 public:
 	// Sets default values for this character's properties
@@ -71,7 +105,7 @@ public:
 	FORCEINLINE virtual UAbilitySystemComponent* GetAbilitySystemComponent() const override { return AbilitySystemComponent; }
 
 	UFUNCTION(BlueprintPure, Category="Ability System", meta=(CompactNodeTitle="Alive"))
-	FORCEINLINE bool IsCharacterAlive() const { return CommonAttributeSet ? CommonAttributeSet->GetHealth() > 0 : false; }
+	FORCEINLINE bool IsCharacterAlive() const { return !_isDead && (CommonAttributeSet ? CommonAttributeSet->GetHealth() > 0 : false); }
 
 	UFUNCTION(BlueprintPure, meta=(CompactNodeTitle="CommonAttributes"))
 	FORCEINLINE UCommonCharacterAttributeSet* GetCommonAttributeSet() const { return CommonAttributeSet ? CommonAttributeSet : nullptr; }
@@ -91,8 +125,14 @@ public:
 	UPROPERTY(EditAnywhere, Category="Ability System|Attributes")
 	EFCEase DashEasing = EFCEase::InOutExpo;
 
-	UFUNCTION()
-	void OnHealthChanged_Internal(float ChangeDelta, float NewValue, bool HitLimit);
+	// Bound to the ability system attribute changes, which fire on the server and on the clients receiving the replicated values
+	void OnHealthChanged_Internal(const FOnAttributeChangeData& Data);
+
+	void OnMaxHealthChanged_Internal(const FOnAttributeChangeData& Data);
+
+	// Tag the character as dead and broadcast OnCharacterDied. Only the first call does anything
+	UFUNCTION(BlueprintCallable, Category = "Combat")
+	void Die();
 
 
 	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="Combat", meta=(ExposeOnSpawn=true))
@@ -108,6 +148,34 @@ public:
 	FCharacterDiedSignature OnCharacterDied;
 
 	
+	// The compiled stats of the CharacterData, defaults until BeginPlay
+	UFUNCTION(BlueprintPure, Category = "Datas", meta=(CompactNodeTitle="Stats"))
+	FCompiledCharacterStats GetCompiledStats() const { return GetStats(); }
+
+	FORCEINLINE const FCompiledCharacterStats& GetStats() const { static const FCompiledCharacterStats defaults; return _statTable ? _statTable->GetStats(_statIndex) : defaults; }
+
+	// Base speed of the stats picked for MaxWalkSpeed, scaled by the MoveSpeedMultiplier attribute
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, ReplicatedUsing = OnRep_SpeedMode, Category = "Character|Movement")
+	ECharacterSpeedMode SpeedMode = ECharacterSpeedMode::Walk;
+
+	UFUNCTION()
+	void OnRep_SpeedMode();
+
+	// Switch speed mode. The speed is applied once on the next tick, whatever the number of changes
+	UFUNCTION(BlueprintCallable, Category = "Character|Movement")
+	void SetSpeedMode(ECharacterSpeedMode NewSpeedMode);
+
+	// Recompute MaxWalkSpeed on the next tick
+	void MarkSpeedDirty();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	UFUNCTION(BlueprintPure, Category = "Combat", meta=(CompactNodeTitle="Significance"))
+	FORCEINLINE ECombatSignificance GetSignificance() const { return _significance; }
+
+	// Update rate of the movement and meshes, set by the combat significance. Does nothing if already at that significance
+	void ApplySignificance(ECombatSignificance significance, float tickInterval);
+
 	UFUNCTION(BlueprintPure, meta=(CompactNodeTitle="MovingToAnchor"))
 	FORCEINLINE EMoveToAnchorType CurrentAnchorMovementType() const { return _movingToAnchorType; }
 	
@@ -6,10 +6,16 @@
 #include "BaseGasCharacter.h"
 #include "Components/CharacterAnchor.h"
 #include "GameFramework/Actor.h"
+#include "WorldCollision.h"
 #include "Camera/CameraComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Components/BillboardComponent.h"
+#include "Engine/StreamableManager.h"
 #include "GameDataTypes/CombatData.h"
+#include "Combat/CombatSpatialGrid.h"
+#include "Combat/CombatRules.h"
+#include "Combat/CombatReplication.h"
+#include "Combat/CombatTelemetry.h"
 #include "CombatManager.generated.h"
 
 
@@ -24,10 +30,109 @@ enum class ECombatPhase : uint8
 	Ended UMETA(ToolTip = "During the outro traversal, before the map is unloaded"),
 };
 
+UENUM(BlueprintType)
+enum class ESpawnPointStrategy : uint8
+{
+	Random UMETA(ToolTip = "Pick a random spawn point"),
+	RoundRobin UMETA(ToolTip = "Cycle through the spawn points in order"),
+	FarthestFromHeroes UMETA(ToolTip = "Pick the spawn point the farthest from the heroes"),
+	LeastRecentlyUsed UMETA(ToolTip = "Pick the spawn point unused for the longest time"),
+};
+
+enum class ECameraCommandType : uint8
+{
+	Move,
+	Fade,
+};
+
+// What happens once a camera command ends
+enum class ECameraCommandEvent : uint8
+{
+	None,
+	BeginingCameraReady,
+	EndingCameraReady,
+	EndedFadeCompleted,
+};
+
+/**
+ * A queued camera move or fade. Commands run one after the other
+ */
+struct FCameraCommand
+{
+	uint32 Handle = 0;
+	ECameraCommandType Type = ECameraCommandType::Move;
+	TWeakObjectPtr<AActor> Target;
+	float Duration = 0;
+	float FromAlpha = 0;
+	float ToAlpha = 0;
+	FLinearColor Color = FLinearColor::Black;
+	ECameraCommandEvent OnEnded = ECameraCommandEvent::None;
+};
+
+/**
+ * A traversal ability granted to a hero, kept across stages while the traversal class stays the same
+ */
+struct FTraversalGrant
+{
+	TWeakObjectPtr<UAbilitySystemComponent> AbilitySystem;
+	TSubclassOf<UGameplayAbility> Ability;
+	FGameplayAbilitySpecHandle Handle;
+};
+
+/**
+ * An enemy of the current wave waiting for its spawn, drawn as an instance of a proxy mesh
+ */
+struct FEnemyProxy
+{
+	// Index in the schedule enemies
+	int32 EnemyIndex = INDEX_NONE;
+	// Pool and instance of the drawn mesh, none when the enemy has no proxy mesh
+	int32 Pool = INDEX_NONE;
+	int32 Instance = INDEX_NONE;
+	// Where the enemy is drawn while it waits. Its actor spawns at a spawn point
+	FTransform Transform;
+};
+
+/**
+ * Everything the anchors snapping depends on. Compared in full, the hash only picks the bucket
+ */
+struct FAnchorSnapKey
+{
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FVector Scale = FVector::OneVector;
+	float SnapDistance = 0;
+	float SnapElevation = 0;
+	TArray<FVector> HeroAnchorLocations;
+	TArray<FVector> EnemyAnchorLocations;
+	uint32 Hash = 0;
+
+	FORCEINLINE bool operator==(const FAnchorSnapKey& other) const
+	{
+		return Hash == other.Hash && Location == other.Location && Rotation == other.Rotation && Scale == other.Scale
+			&& SnapDistance == other.SnapDistance && SnapElevation == other.SnapElevation
+			&& HeroAnchorLocations == other.HeroAnchorLocations && EnemyAnchorLocations == other.EnemyAnchorLocations;
+	}
+
+	friend FORCEINLINE uint32 GetTypeHash(const FAnchorSnapKey& key) { return key.Hash; }
+};
+
+/**
+ * A loaded enemy waiting for an anchor to spawn onto
+ */
+struct FHeldEnemySpawn
+{
+	FPrimaryAssetId EnemyID;
+	FTransform Spawn;
+	double RequestTime = 0;
+};
+
 class ACombatManager;
+class UInstancedStaticMeshComponent;
 DECLARE_DYNAMIC_MULTICAST_SPARSE_DELEGATE_OneParam(FOnPhaseChangedSignature, ACombatManager, OnStateChanged, ECombatPhase, NewCombatPhase);
 DECLARE_DYNAMIC_MULTICAST_SPARSE_DELEGATE_OneParam(FOnPhaseEndedSignature, ACombatManager, OnPhaseEnded, ECombatPhase, EndedCombatPhase);
 DECLARE_DYNAMIC_MULTICAST_SPARSE_DELEGATE_OneParam(FOnPlayerSpawnSignature, ACombatManager, OnPlayerSpawn, ABaseGasCharacter*, PlayerActor);
+DECLARE_DYNAMIC_MULTICAST_SPARSE_DELEGATE_OneParam(FOnCharactersDiedSignature, ACombatManager, OnCharactersDied, const TArray<ABaseGasCharacter*>&, DiedCharacters);
 
 
 /**
@@ -69,6 +174,14 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Anchors")
 	float AnchorSnapElevation = 99;
 
+	// Interval at which anchors are polled, as a safety net for their overlap events. Only during Opening, Begining and Active
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Anchors")
+	float AnchorPollInterval = 0.25f;
+
+	// Cell size of the spatial index used by the targeting queries
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Anchors")
+	float SpatialCellSize = 400.f;
+
 
 	// Level ____________________________________________________________________________________________________________________________________
 
@@ -78,18 +191,30 @@ protected:
 	UPROPERTY(VisibleDefaultsOnly, BlueprintReadOnly, Category = "Level")
 	TObjectPtr<UCameraComponent> LevelCamera;
 
+	// Throttles the least significant characters, holds the per frame character budget
+	UPROPERTY(VisibleDefaultsOnly, BlueprintReadOnly, Category = "Level")
+	TObjectPtr<class UCombatSignificanceComponent> Significance;
+
 	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Level", meta = (MakeEditWidget = true))
 	TArray<FTransform> HeroSpawns;
 
 	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Level", meta = (MakeEditWidget = true))
 	TArray<FTransform> EnemySpawns;
 
+	// How the enemy spawn point is chosen among EnemySpawns
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level")
+	ESpawnPointStrategy SpawnPointStrategy = ESpawnPointStrategy::Random;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Level")
 	ECombatPhase CurrentPhase = ECombatPhase::Opening;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Level")
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_CombatDataID, Category = "Level")
 	FPrimaryAssetId CombatDataID;
 
+	// Set with the combat data, so clients build the same scaled schedule as the server
+	UPROPERTY(ReplicatedUsing = OnRep_CombatDifficulty)
+	FReplicatedCombatDifficulty CombatDifficulty;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Level")
 	TObjectPtr<UCombatData> CombatData;
 
@@ -102,16 +227,105 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level")
 	bool AutoInitCombat = true;
 
+	// Time a dead enemy stays in the arena before the default despawn destroys it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level")
+	float DeadDespawnDelay = 2.0f;
+
+	// When set, this combat runs this data instead of the level current stage, and leaves the level stages untouched. Used by arenas running several combats
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Level", meta = (AllowedTypes = "CombatData"))
+	FPrimaryAssetId ArenaCombatData;
+
+	// Local player taking part in this combat. Its controller possesses the hero and receives the camera commands
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level")
+	int32 PlayerIndex = 0;
+
+	// Run without player nor camera: camera commands complete instantly and traversals are skipped. Used to load test combat datas
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulation")
+	bool bHeadless = false;
+
+	// Show the enemies waiting in the current wave as instanced proxy meshes. Purely cosmetic: enemies still spawn at the spawn points, and dedicated servers draw none
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level|Proxies")
+	bool bUseEnemyProxies = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level|Proxies", meta = (ClampMin = 0))
+	int32 MaxEnemyProxies = 64;
+
+	// Distance between the rows of proxies queued behind each enemy spawn point
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level|Proxies")
+	float ProxyRowSpacing = 150.f;
+
+	// Seed of the enemy spawn points selection. When 0, the seed is derived from the combat data ID
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulation")
+	int32 SpawnSeed = 0;
+
+
+	// Replication ____________________________________________________________________________________________________________________________________
+
+	UPROPERTY(Replicated)
+	FReplicatedAnchorArray ReplicatedAnchors;
+
+	UPROPERTY(Replicated)
+	FReplicatedEnemyRoster ReplicatedEnemies;
+
+	UPROPERTY(ReplicatedUsing = OnRep_CombatCursor)
+	FReplicatedCombatCursor ReplicatedCursor;
+
+	FCombatNetStats NetStats;
+	FCombatTelemetry Telemetry;
+	// Upcoming wave enemies, loaded ahead on clients
+	TSharedPtr<FStreamableHandle> WavePrefetchHandle;
+
 	
 
-	TFunction<void(bool)> OnCameraMoveEnded;
-	TFunction<void(bool)> OnCameraFadeEnded;
-	FEnemyWave CurrentWave;
-	TQueue<FEnemyWave> WaveQueue;
-	TQueue<FPrimaryAssetId> SpawnQueue;
-	float SpawnTimer;
-	bool bIsSpawning = false;
+	// Camera commands, the first one is running
+	TArray<FCameraCommand, TInlineAllocator<4>> CameraCommands;
+	FTimerHandle CameraCommandTimer;
+	uint32 LastCameraCommandHandle = 0;
+	bool bIsProcessingCameraCommands = false;
+	bool bMadeTraversalOutro = false;
+	TArray<FTraversalGrant, TInlineAllocator<4>> TraversalGrants;
+	// Proxies of the current wave, in spawn order and contiguous
+	TArray<FEnemyProxy> EnemyProxies;
+	// One instanced mesh per proxy mesh, with its hidden instances ready for reuse
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UInstancedStaticMeshComponent>> ProxyPools;
+	TArray<TArray<int32>> ProxyFreeInstances;
+	const FCompiledWaveSchedule* WaveSchedule = nullptr;
+	// The schedule of the combat data with the difficulty applied, unused when the difficulty keeps the authored waves
+	FCompiledWaveSchedule ScaledWaveSchedule;
+	FWaveCursor WaveCursor;
+	FRandomStream SpawnStream;
+	// Spawn points in world space, computed at BeginPlay on every net mode and again at InitCombat
+	TArray<FTransform> WorldHeroSpawns;
+	TArray<FTransform> WorldEnemySpawns;
+	// Spawn count at which each enemy spawn point was last used
+	TArray<int32> EnemySpawnLastUse;
+	int32 EnemySpawnCount = 0;
+	float SpawnTimer = 0;
+	FTimerHandle SpawnTimerHandle;
+	// Enemies loading, each with an anchor kept for it. Held enemies still count as in flight
+	int32 InFlightSpawns = 0;
+	TArray<TWeakObjectPtr<UCharacterAnchor>, TInlineAllocator<8>> SpawnReservedAnchors;
+	// Loaded enemies that found no anchor left, spawned first when one frees up
+	TArray<FHeldEnemySpawn, TInlineAllocator<4>> HeldEnemySpawns;
+	// Spawn and formation rules, shared with FCombatSimulator. Enemies are reassigned on the next tick after the anchor set changed
+	FCombatRules CombatRules;
+	FTimerHandle FormationTimerHandle;
+	bool bIsFormationDirty = false;
+	bool bIsSolvingFormation = false;
 	bool _wasLastStage = false;
+	// Characters died this frame, cleaned up together on the next tick
+	TArray<TWeakObjectPtr<ABaseGasCharacter>> PendingDeaths;
+	FTimerHandle DeathFlushHandle;
+	// Anchor world locations of the running snap batch, heroes then enemies
+	TArray<FVector> AnchorSnapResults;
+	uint32 AnchorSnapGeneration = 0;
+	int32 PendingAnchorTraces = 0;
+	// Key of the running snap batch, its results are stored under it
+	FAnchorSnapKey AnchorSnapKey;
+	// Anchors and live characters, characters are refreshed at most once per frame when queried
+	FCombatSpatialGrid SpatialGrid;
+	uint64 SpatialGridFrame = 0;
 
 
 
@@ -139,11 +353,71 @@ protected:
 	UFUNCTION(BlueprintPure, Category = "Level", meta = (CompactNodeTitle = "IsLastCombat"))
 	FORCEINLINE bool IsTheLastCombat() const { return _wasLastStage; }
 
+	// Count the enemies in scene still alive
+	int32 CountAliveEnemies() const;
+
 
 
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	UFUNCTION()
+	void OnRep_CombatDataID();
+
+	UFUNCTION()
+	void OnRep_CombatDifficulty();
+
+	UFUNCTION()
+	void OnRep_CombatCursor();
+
+	UFUNCTION()
+	void OnClientCombatDataLoaded_Internal(FPrimaryAssetId stageID);
+
+	// Copy the phase and wave cursor to their replicated version, server only
+	void UpdateReplicatedCursor();
+
+	// Copy an anchor state to its replicated version, server only
+	void UpdateReplicatedAnchor(const UCharacterAnchor* anchor);
+
+	// Load the enemies of the current and next waves ahead of their spawn
+	void PrefetchUpcomingWaves();
+
+	// Point WaveSchedule to the combat data schedule, scaled by the level difficulty
+	void BuildWaveSchedule();
+
+	// Match the proxies to the enemies still waiting in the current wave
+	void SyncEnemyProxies();
+
+	FTransform GetEnemyProxyTransform(int32 waveEnemyIndex) const;
+
+	// Move the hero and enemy spawn points to world space
+	void BuildWorldSpawns();
+
+	// Hide the proxy instance, kept for the next proxy of the same mesh
+	void ReleaseEnemyProxy(const FEnemyProxy& proxy);
+
+	// Grant the traversal to the hero, or get the spec it was already granted
+	FGameplayAbilitySpecHandle GrantTraversal(ABaseGasCharacter* hero, TSubclassOf<UGameplayAbility> traversal);
+
+	// Grant the stage traversals ahead of their activation, so instanced abilities are created at spawn
+	void PreGrantTraversals(ABaseGasCharacter* hero);
+
+	// Activate an already granted traversal, granting it if needed. Return false if the hero has no such traversal
+	bool ActivateTraversal(ABaseGasCharacter* hero, const TSoftClassPtr<UGameplayAbility>& traversal);
+
+	// Remove the granted traversals, except the ones of the current combat data when bKeepStageTraversals is set
+	void ReleaseTraversalGrants(bool bKeepStageTraversals);
+
+	// The level subsystem, only if this combat drives the level stages
+	class ULevelSubsystem* GetStageSubsystem() const;
+
+	// Register an actor of this combat to the combat subsystem
+	void RegisterCombatActor(AActor* actor);
+
 	UFUNCTION()
 	void OnStageLoaded_Internal(FPrimaryAssetId stageID);
 
@@ -154,19 +428,84 @@ protected:
 	void OnHeroLoaded_Internal(FPrimaryAssetId heroID, FTransform Spawn, UCharacterAnchor* charAnchor = nullptr);
 
 	UFUNCTION()
-	void OnEnemyLoaded_Internal(FPrimaryAssetId enemyID, FTransform Spawn, UCharacterAnchor* charAnchor = nullptr);
+	void OnEnemyLoaded_Internal(FPrimaryAssetId enemyID, FTransform Spawn, UCharacterAnchor* charAnchor = nullptr, double requestTime = 0);
+
+	// Publish the alive enemies count to the stats and trace counters
+	void UpdateAliveEnemiesTelemetry();
 
 	UFUNCTION()
 	void OnEnemyDestroyed_Internal(AActor* actor);
 
 	UFUNCTION()
-	void OnCameraMoveCommand_Internal();
+	void OnHeroDestroyed_Internal(AActor* actor);
+
+	UFUNCTION()
+	void OnCharacterDied_Internal(AActor* actor);
+
+	// Run the death pipeline of the characters died since the last flush. Heroes only release their anchor, enemies also leave the roster and despawn
+	void FlushDeaths();
+
+	// Get rid of a dead enemy already out of the combat. Destroy it after DeadDespawnDelay by default, override to return it to a pool
+	UFUNCTION(BlueprintNativeEvent, Category = "Level")
+	void DespawnDeadCharacter(ABaseGasCharacter* character);
+
+	UFUNCTION()
+	void OnAnchorStateChanged_Internal(UCharacterAnchor* anchor, EAnchorState lastState, EAnchorState newState);
+
+	UFUNCTION()
+	void OnSpawnTimer_Internal();
 
 	UFUNCTION()
-	void OnCameraFadeCommand_Internal();
+	void OnCameraCommandTimer_Internal();
+
+	void OnCameraCommandEnded(ECameraCommandEvent event, bool success);
+
+	// Run the queued camera commands until one has to wait
+	void ProcessCameraCommands();
+
+	// Start a camera command. Return its duration, or a negative value if it can't run
+	float ExecuteCameraCommand(const FCameraCommand& command);
+
+	void CompleteCameraCommand(int32 index, bool success);
 
 	void SetCombatPhase(ECombatPhase phase);
 
+	// Enable the work the phase needs and stop the rest
+	void ApplyPhaseSchedule(ECombatPhase phase);
+
+	// Request a formation solve, once per frame whatever the number of anchor changes
+	void MarkFormationDirty();
+
+	// Move the enemies to the front-most anchors, with the minimal total travel
+	UFUNCTION()
+	void SolveEnemyFormation();
+
+	// Try to spawn enemies once the spawn delay is over, if an anchor is free
+	void ScheduleSpawn();
+
+	// Pick the enemy spawn point following SpawnPointStrategy
+	int32 SelectEnemySpawnPoint();
+
+	// The back-most free anchor not kept for a loading enemy
+	UCharacterAnchor* FindSpawnAnchor() const;
+
+	// The enemy anchors as seen by the combat rules, with their components at the same indices
+	void GatherAnchorSlots(TArray<FCombatAnchorSlot, TInlineAllocator<32>>& outSlots, TArray<UCharacterAnchor*, TInlineAllocator<32>>& outAnchors) const;
+
+	// Move the characters in the spatial index, once per frame
+	void UpdateSpatialGrid();
+
+	// Reuse the anchor components, only creating or destroying the difference with the count
+	void SyncAnchorComponents(TArray<TObjectPtr<UCharacterAnchor>>& anchors, int32 count, const TCHAR* prefix);
+
+	// Move the anchors to world locations, heroes then enemies
+	void ApplyAnchorLocations(const TArray<FVector>& worldLocations);
+
+	// Everything the anchors snapping depends on, to share the snapped locations between combats
+	FAnchorSnapKey MakeAnchorSnapKey() const;
+
+	void OnAnchorTraceDone(const FTraceHandle& handle, FTraceDatum& datum, uint32 generation);
+
 public:
 
 	UPROPERTY(BlueprintAssignable, Category = "Events")
@@ -178,22 +517,61 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Events")
 	FOnPlayerSpawnSignature OnPlayerSpawn;
 
+	// The enemies died during the last frame, once out of the combat
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnCharactersDiedSignature OnCharactersDied;
+
 
+	FORCEINLINE const TArray<TObjectPtr<UCharacterAnchor>>& GetHeroAnchors() const { return HeroAnchors; }
 
+	FORCEINLINE const TArray<TObjectPtr<UCharacterAnchor>>& GetEnemyAnchors() const { return EnemyAnchors; }
 
-	// Called every frame
+	FORCEINLINE const TArray<TObjectPtr<ABaseGasCharacter>>& GetHeroesInScene() const { return HeroesInScene; }
+
+	FORCEINLINE const TArray<TObjectPtr<ABaseGasCharacter>>& GetEnemiesInScene() const { return EnemiesInScene; }
+
+	UFUNCTION(BlueprintPure, Category = "Level", meta = (CompactNodeTitle = "Phase"))
+	FORCEINLINE ECombatPhase GetCombatPhase() const { return CurrentPhase; }
+
+	// The controller of the player taking part in this combat
+	UFUNCTION(BlueprintPure, Category = "Level")
+	class APlayerController* GetCombatPlayerController() const;
+
+	FORCEINLINE FCombatNetStats& GetNetStats() { return NetStats; }
+
+	FORCEINLINE const FCombatTelemetry& GetTelemetry() const { return Telemetry; }
+
+	// A client received an anchor, mirror it with a local anchor component
+	void OnAnchorReplicated(const FReplicatedAnchor& replicatedAnchor);
+
+	// Spatial index of the anchors and live characters, up to date for this frame
+	const FCombatSpatialGrid& GetSpatialGrid();
+
+	// The first free anchor met going from start to end, within radius of the line
+	UFUNCTION(BlueprintCallable, Category = "Anchors")
+	UCharacterAnchor* FindFirstFreeAnchorAlongLine(FVector start, FVector end, float radius, bool enemyAnchors = true);
+
+
+
+	// Called while the phase needs anchor polling
 	virtual void Tick(float DeltaTime) override;
 
-	// Update the anchors
+	// Poll the anchors state
 	void UpdateAnchors(float DeltaTime);
 
-	// Move the camera to the target actor
-	void MoveCameraCommand(AActor* target, const float blendTime, TFunction<void(bool)> onCameraMoveEnded);
+	// Queue a camera move to the target actor. Return the command handle
+	uint32 MoveCameraCommand(AActor* target, const float blendTime, ECameraCommandEvent onCameraMoveEnded = ECameraCommandEvent::None);
 
-	// Fade the camera to the target alpha, with the atrget color
-	void FadeCameraCommand(const float fromAlpha, const float toAlpha, const float fadeTime, FLinearColor color, TFunction<void(bool)> onCameraFadeEnded);
+	// Queue a camera fade to the target alpha, with the target color. Return the command handle
+	uint32 FadeCameraCommand(const float fromAlpha, const float toAlpha, const float fadeTime, FLinearColor color, ECameraCommandEvent onCameraFadeEnded = ECameraCommandEvent::None);
 
-	// Place anchors on the ground
+	// Cancel a running or pending camera command, it ends unsuccessfully
+	bool CancelCameraCommand(uint32 handle);
+
+	// Cancel all the camera commands
+	void CancelCameraCommands();
+
+	// Place anchors on the ground. Snapping traces run async and are cached per transform in the combat subsystem
 	UFUNCTION(BlueprintCallable, Category = "Anchors")
 	void PlaceAnchors();
 
@@ -217,13 +595,19 @@ public:
 	UFUNCTION(BlueprintImplementableEvent, Category = "Level")
 	ABaseGasCharacter* SpawnCharacter(UBaseCharacterData* data, const FTransform spawnTr, UCharacterAnchor* charAnchor = nullptr);
 
+	// Take a spawned hero into the combat: registered to the combat subsystem and bound to the death pipeline
+	void AddHeroToCombat(ABaseGasCharacter* hero);
+
+	// Take a spawned enemy into the combat roster, registered and bound like the wave enemies
+	void AddEnemyToCombat(ABaseGasCharacter* enemy, const FPrimaryAssetId& enemyID);
+
 	// Select Next Wave and try to spwn it; or end the combat if no more waves are available
 	UFUNCTION(BlueprintCallable, Category = "Level")
 	void CreateNextWave();
 
-	// Try Spawn Enemy from the current wave
+	// Try Spawn Enemies from the current wave, up to the wave burst
 	UFUNCTION(BlueprintCallable, Category = "Level")
-	bool TrySpawnEnemy(float DeltaTime);
+	bool TrySpawnEnemy();
 
 	// Spawn Enemy
 	UFUNCTION(BlueprintCallable, Category = "Level")
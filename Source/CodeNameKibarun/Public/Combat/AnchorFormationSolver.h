@@ -0,0 +1,29 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/**
+ * Assign characters to anchors with the minimal total travel distance (Hungarian algorithm, O(n²m)).
+ * Keeps its working buffers between solves, so a combat can hold one and solve each time its anchors change.
+ */
+class CODENAMEKIBARUN_API FAnchorFormationSolver
+{
+public:
+
+	// Fill outAssignment with the anchor index of each character. There can't be more characters than anchors
+	bool Solve(TConstArrayView<FVector> characters, TConstArrayView<FVector> anchors, TArray<int32>& outAssignment);
+
+private:
+
+	// Row and column potentials, column matching and search state, all 1-based as the algorithm goes
+	TArray<double> RowPotentials;
+	TArray<double> ColumnPotentials;
+	TArray<double> MinSlack;
+	TArray<int32> ColumnMatch;
+	TArray<int32> ColumnWay;
+	TArray<bool> ColumnUsed;
+	TArray<double> Costs;
+};
@@ -0,0 +1,186 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "Engine/NetSerialization.h"
+#include "Components/CharacterAnchor.h"
+#include "GameDataTypes/CombatData.h"
+#include "CombatReplication.generated.h"
+
+
+class ACombatManager;
+
+
+/**
+ * Bits written by the replicated combat state of a manager, used to watch the bandwidth of each combat
+ */
+struct FCombatNetStats
+{
+	uint64 BitsWritten = 0;
+	double StartTime = 0;
+
+	FORCEINLINE void Reset(double time) { BitsWritten = 0; StartTime = time; }
+
+	FORCEINLINE double GetBytesPerSecond(double time) const { return time > StartTime ? (BitsWritten / 8.0) / (time - StartTime) : 0; }
+};
+
+
+/**
+ * Replicated state of one anchor
+ */
+USTRUCT()
+struct FReplicatedAnchor : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	// Index in the hero or enemy anchors. Formations go past 256 anchors
+	UPROPERTY()
+	uint16 Index = 0;
+
+	UPROPERTY()
+	bool bIsEnemy = false;
+
+	UPROPERTY()
+	EAnchorState State = EAnchorState::Free;
+
+	UPROPERTY()
+	FVector_NetQuantize10 Location = FVector::ZeroVector;
+
+	UPROPERTY()
+	TObjectPtr<ABaseGasCharacter> Owner = nullptr;
+
+	void PostReplicatedAdd(const struct FReplicatedAnchorArray& InArraySerializer);
+	void PostReplicatedChange(const struct FReplicatedAnchorArray& InArraySerializer);
+};
+
+USTRUCT()
+struct FReplicatedAnchorArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FReplicatedAnchor> Items;
+
+	// Not replicated, the manager owning the array
+	TWeakObjectPtr<ACombatManager> Manager;
+
+	// Add or update an anchor, only dirtying what changed. Indices past MAX_uint16 are refused
+	void SetAnchor(int32 index, bool isEnemy, const UCharacterAnchor* anchor);
+
+	// Drop the anchors past these counts
+	void Trim(int32 heroCount, int32 enemyCount);
+
+	const FReplicatedAnchor* Find(int32 index, bool isEnemy) const;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+};
+
+template<>
+struct TStructOpsTypeTraits<FReplicatedAnchorArray> : public TStructOpsTypeTraitsBase2<FReplicatedAnchorArray>
+{
+	enum { WithNetDeltaSerializer = true };
+};
+
+
+/**
+ * Replicated entry of the enemy roster
+ */
+USTRUCT()
+struct FReplicatedEnemy : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<ABaseGasCharacter> Character = nullptr;
+
+	UPROPERTY()
+	FPrimaryAssetId EnemyID;
+
+	UPROPERTY()
+	uint16 Wave = 0;
+};
+
+USTRUCT()
+struct FReplicatedEnemyRoster : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FReplicatedEnemy> Items;
+
+	// Not replicated, the manager owning the roster
+	TWeakObjectPtr<ACombatManager> Manager;
+
+	void AddEnemy(ABaseGasCharacter* character, const FPrimaryAssetId& enemyID, uint16 wave);
+
+	void RemoveEnemy(const AActor* character);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+};
+
+template<>
+struct TStructOpsTypeTraits<FReplicatedEnemyRoster> : public TStructOpsTypeTraitsBase2<FReplicatedEnemyRoster>
+{
+	enum { WithNetDeltaSerializer = true };
+};
+
+
+/**
+ * Difficulty the server runs a combat with. Clients scale the schedule and the enemy stats from it, never from their own settings
+ */
+USTRUCT()
+struct FReplicatedCombatDifficulty
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FCombatDifficulty Difficulty;
+
+	UPROPERTY()
+	int32 StageIndex = 0;
+};
+
+
+/**
+ * Phase and wave cursor of a combat, packed in a single variable length integer
+ */
+USTRUCT()
+struct FReplicatedCombatCursor
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	uint8 Phase = 0;
+
+	UPROPERTY()
+	bool bHasBeganSpawn = false;
+
+	// Wave index plus one, 0 before the first wave
+	UPROPERTY()
+	uint16 WaveIndex = 0;
+
+	UPROPERTY()
+	uint16 EnemyIndex = 0;
+
+	// Not replicated, the manager owning the cursor
+	TWeakObjectPtr<ACombatManager> Manager;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	FORCEINLINE bool operator==(const FReplicatedCombatCursor& other) const
+	{
+		return Phase == other.Phase && bHasBeganSpawn == other.bHasBeganSpawn && WaveIndex == other.WaveIndex && EnemyIndex == other.EnemyIndex;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FReplicatedCombatCursor> : public TStructOpsTypeTraitsBase2<FReplicatedCombatCursor>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
@@ -0,0 +1,77 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameDataTypes/CombatData.h"
+#include "Combat/AnchorFormationSolver.h"
+
+enum class ECombatPhase : uint8;
+
+
+/**
+ * An enemy anchor as seen by the combat rules
+ */
+struct FCombatAnchorSlot
+{
+	FVector Location = FVector::ZeroVector;
+	// Where the owner stands, when there is one
+	FVector OwnerLocation = FVector::ZeroVector;
+	bool bHasOwner = false;
+	// Kept for an enemy still loading
+	bool bSpawnReserved = false;
+
+	FORCEINLINE bool IsFree() const { return !bHasOwner && !bSpawnReserved; }
+};
+
+
+/**
+ * Outcome of a spawn attempt
+ */
+enum class ECombatSpawnStep : uint8
+{
+	// The wave rules or the anchors don't allow a spawn now
+	Blocked,
+	// An enemy was popped, it goes to the spawn anchor
+	Spawn,
+	// The wave has no enemy left, move to the next one
+	WaveDone,
+};
+
+
+/**
+ * Spawn, anchor and formation rules of a combat, without world nor actor.
+ * ACombatManager runs them on its anchor components and FCombatSimulator on simulated anchors, so a simulation follows the game.
+ * Enemy anchors go front-most first: enemies spawn on the back-most free anchor, and the formation moves them up to the front ones.
+ */
+class CODENAMEKIBARUN_API FCombatRules
+{
+public:
+
+	// Enemies only spawn while opening or fighting
+	static bool SpawnsDuring(ECombatPhase phase);
+
+	// Back-most free anchor, where the next enemy spawns. INDEX_NONE when every anchor is owned or kept
+	static int32 FindSpawnAnchor(TConstArrayView<FCombatAnchorSlot> anchors);
+
+	static int32 CountFreeAnchors(TConstArrayView<FCombatAnchorSlot> anchors);
+
+	// Whether the wave takes a new spawn with that many enemies already in flight
+	static bool CanStartSpawn(const FCompiledWave* wave, int32 inFlightSpawns);
+
+	// Pop the next enemy of the current wave, when the wave spawn rules and the free anchors allow it
+	static ECombatSpawnStep PopNextSpawn(const FCompiledWaveSchedule& schedule, FWaveCursor& cursor, TConstArrayView<FCombatAnchorSlot> anchors, int32 inFlightSpawns, FPrimaryAssetId& outEnemyID);
+
+	// Move the owners to as many front-most anchors with the least total travel, leaving the anchors kept for spawns alone.
+	// Each move is the anchor left then the anchor taken: release all the left anchors before taking any
+	bool SolveFormation(TConstArrayView<FCombatAnchorSlot> anchors, TArray<TPair<int32, int32>>& outMoves);
+
+private:
+
+	FAnchorFormationSolver Solver;
+	TArray<int32> OwnedAnchors;
+	TArray<FVector> OwnerLocations;
+	TArray<int32> TargetAnchors;
+	TArray<FVector> TargetLocations;
+	TArray<int32> Assignment;
+};
@@ -0,0 +1,127 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "CombatSpatialGrid.generated.h"
+
+
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = true))
+enum class ECombatSpatialKind : uint8
+{
+	None = 0 UMETA(Hidden),
+	HeroAnchor = 1 << 0 UMETA(ToolTip = "Anchors of the heroes"),
+	EnemyAnchor = 1 << 1 UMETA(ToolTip = "Anchors of the enemies"),
+	Hero = 1 << 2 UMETA(ToolTip = "Live heroes"),
+	Enemy = 1 << 3 UMETA(ToolTip = "Live enemies"),
+};
+ENUM_CLASS_FLAGS(ECombatSpatialKind)
+
+
+/**
+ * An anchor or character indexed by the grid
+ */
+struct FCombatSpatialEntry
+{
+	TWeakObjectPtr<UObject> Object;
+	FVector Location = FVector::ZeroVector;
+	FIntPoint Cell = FIntPoint::ZeroValue;
+	ECombatSpatialKind Kind = ECombatSpatialKind::None;
+};
+
+
+/**
+ * Uniform grid over the ground plane of a combat. Entries only change bucket when they cross a cell,
+ * so moving characters can be refreshed every frame for the cost of a location compare.
+ */
+class CODENAMEKIBARUN_API FCombatSpatialGrid
+{
+public:
+
+	explicit FCombatSpatialGrid(float cellSize = 400.f);
+
+	void Reset(float cellSize);
+
+	// Add an entry, or move it if already indexed
+	void Update(UObject* object, const FVector& location, ECombatSpatialKind kind);
+
+	void Remove(const UObject* object);
+
+	// Drop the entries whose object is gone
+	void RemoveStale();
+
+	FORCEINLINE int32 Num() const { return Entries.Num(); }
+
+	// Entries within the radius, unordered
+	void QueryRadius(const FVector& center, float radius, ECombatSpatialKind kinds, TArray<UObject*>& outResults) const;
+
+	// The closest entries, nearest first
+	void QueryNearest(const FVector& center, int32 count, ECombatSpatialKind kinds, TArray<UObject*>& outResults, float maxRadius = UE_BIG_NUMBER) const;
+
+	// Entries inside a cone, nearest first
+	void QueryCone(const FVector& origin, const FVector& direction, float halfAngleDegrees, float length, ECombatSpatialKind kinds, TArray<UObject*>& outResults) const;
+
+	// Entries within the radius of a segment, ordered along the segment
+	void QueryLine(const FVector& start, const FVector& end, float radius, ECombatSpatialKind kinds, TArray<UObject*>& outResults) const;
+
+private:
+
+	float CellSize = 400.f;
+	TSparseArray<FCombatSpatialEntry> Entries;
+	TMap<TObjectKey<UObject>, int32> EntryIndices;
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+	FORCEINLINE FIntPoint GetCell(const FVector& location) const
+	{
+		return FIntPoint(FMath::FloorToInt32(location.X / CellSize), FMath::FloorToInt32(location.Y / CellSize));
+	}
+
+	// Cell of a query bound, clamped so huge radii don't overflow the cell coordinates
+	FORCEINLINE FIntPoint GetClampedCell(const FVector& location) const
+	{
+		const double x = FMath::Clamp(FMath::FloorToDouble(location.X / CellSize), static_cast<double>(MIN_int32), static_cast<double>(MAX_int32));
+		const double y = FMath::Clamp(FMath::FloorToDouble(location.Y / CellSize), static_cast<double>(MIN_int32), static_cast<double>(MAX_int32));
+		return FIntPoint(static_cast<int32>(x), static_cast<int32>(y));
+	}
+
+	template<typename TVisitor>
+	FORCEINLINE void VisitCell(const TArray<int32>& cell, ECombatSpatialKind kinds, TVisitor& visitor) const
+	{
+		for (const int32 index : cell)
+		{
+			const FCombatSpatialEntry& entry = Entries[index];
+			if (EnumHasAnyFlags(entry.Kind, kinds) && entry.Object.IsValid())
+				visitor(entry);
+		}
+	}
+
+	// Call the visitor for each valid entry of the kinds in the cells overlapping the 2D box
+	template<typename TVisitor>
+	void ForEachInBox(const FVector& min, const FVector& max, ECombatSpatialKind kinds, TVisitor&& visitor) const
+	{
+		const FIntPoint minCell = GetClampedCell(min);
+		const FIntPoint maxCell = GetClampedCell(max);
+		if (minCell.X > maxCell.X || minCell.Y > maxCell.Y)
+			return;
+		// A box wider than the occupied cells walks the buckets instead of the empty range
+		const int64 rangeCells = (static_cast<int64>(maxCell.X) - minCell.X + 1) * (static_cast<int64>(maxCell.Y) - minCell.Y + 1);
+		if (rangeCells > Cells.Num())
+		{
+			for (const auto& cell : Cells)
+			{
+				if (cell.Key.X >= minCell.X && cell.Key.X <= maxCell.X && cell.Key.Y >= minCell.Y && cell.Key.Y <= maxCell.Y)
+					VisitCell(cell.Value, kinds, visitor);
+			}
+			return;
+		}
+		for (int32 x = minCell.X; x <= maxCell.X; x++)
+		{
+			for (int32 y = minCell.Y; y <= maxCell.Y; y++)
+			{
+				if (const TArray<int32>* cell = Cells.Find(FIntPoint(x, y)))
+					VisitCell(*cell, kinds, visitor);
+			}
+		}
+	}
+};
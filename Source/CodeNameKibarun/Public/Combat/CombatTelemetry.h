@@ -0,0 +1,64 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+
+/**
+ * Count, sum and range of a timing
+ */
+struct FCombatTelemetrySeries
+{
+	int32 Count = 0;
+	double Total = 0;
+	double Min = 0;
+	double Max = 0;
+
+	void Add(double value)
+	{
+		Min = Count > 0 ? FMath::Min(Min, value) : value;
+		Max = Count > 0 ? FMath::Max(Max, value) : value;
+		Total += value;
+		Count++;
+	}
+
+	FORCEINLINE double GetAverage() const { return Count > 0 ? Total / Count : 0; }
+};
+
+
+/**
+ * Timings of a combat loop, in real seconds. Used to tune the waves spawn settings against the actual loading
+ */
+struct CODENAMEKIBARUN_API FCombatTelemetry
+{
+	static constexpr int32 MaxPhases = 8;
+
+	// Total time spent in each phase, by ECombatPhase value
+	double PhaseDurations[MaxPhases] = {};
+	double PhaseStartTime = 0;
+
+	// From the spawn request to the enemy actor spawned
+	FCombatTelemetrySeries AssetLatency;
+	// From the enemy actor spawned to its anchor occupied
+	FCombatTelemetrySeries SpawnToAnchor;
+	FCombatTelemetrySeries WaveDuration;
+	double WaveStartTime = -1;
+	int32 PeakEnemiesAlive = 0;
+
+	// Spawned enemies still on their way to their first anchor
+	TMap<TObjectKey<AActor>, double> PendingAnchorArrivals;
+
+	void Reset();
+
+	// Close the running phase, and start timing the next one
+	void SwitchPhase(uint8 lastPhase, double time);
+
+	void BeginWave(double time);
+
+	void EndWave(double time);
+
+	// Log a summary of the timings
+	void Dump(const FString& combatName, const UEnum* phaseEnum) const;
+};
@@ -0,0 +1,49 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CombatUIFeed.generated.h"
+
+
+class ABaseGasCharacter;
+
+
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = true))
+enum class ECombatUIChangeFlags : uint8
+{
+	None = 0 UMETA(Hidden),
+	Health = 1 << 0 UMETA(ToolTip = "Health changed"),
+	MaxHealth = 1 << 1 UMETA(ToolTip = "Max health changed"),
+	HitLimit = 1 << 2 UMETA(ToolTip = "Health got clamped to 0 or its max"),
+	Died = 1 << 3 UMETA(ToolTip = "The character died"),
+};
+ENUM_CLASS_FLAGS(ECombatUIChangeFlags)
+
+
+/**
+ * Everything that changed on a character during a frame, for the health bars and damage numbers
+ */
+USTRUCT(BlueprintType)
+struct FCombatUIChange
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Combat|UI")
+	TWeakObjectPtr<ABaseGasCharacter> Character;
+
+	// Health at the first change of the frame
+	UPROPERTY(BlueprintReadOnly, Category = "Combat|UI")
+	float OldHealth = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Combat|UI")
+	float NewHealth = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Combat|UI")
+	float MaxHealth = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Combat|UI", meta = (Bitmask, BitmaskEnum = "/Script/CodeNameKibarun.ECombatUIChangeFlags"))
+	int32 Flags = 0;
+
+	FORCEINLINE bool HasFlag(ECombatUIChangeFlags flag) const { return (Flags & static_cast<int32>(flag)) != 0; }
+};
@@ -0,0 +1,29 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CombatDebugComponent.generated.h"
+
+
+/**
+ * Draw the state of its combat manager. Only created in builds with debug drawing, and only ticks while Kibarun.Combat.DebugDraw is set
+ */
+UCLASS(ClassGroup = "Debug", Transient)
+class CODENAMEKIBARUN_API UCombatDebugComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UCombatDebugComponent();
+
+	virtual void BeginPlay() override;
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Radius of the spheres drawn on anchors
+	UPROPERTY(EditAnywhere, Category = "Debug")
+	float AnchorRadius = 100.f;
+};
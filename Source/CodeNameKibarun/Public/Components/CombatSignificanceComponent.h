@@ -0,0 +1,55 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CombatSignificanceComponent.generated.h"
+
+
+class ABaseGasCharacter;
+
+
+/**
+ * Rank the characters of its combat manager and throttle the movement and animation of the least significant ones.
+ * Heroes always run at full rate. Enemies are ranked by distance to the player view, the ones without anchor last,
+ * and only the budgeted count of them keep a full rate update.
+ */
+UCLASS(ClassGroup = "Combat", meta = (BlueprintSpawnableComponent))
+class CODENAMEKIBARUN_API UCombatSignificanceComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UCombatSignificanceComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Enemies updated every frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance", meta = (ClampMin = 0))
+	int32 HighSignificanceBudget = 8;
+
+	// Enemies updated at MediumTickInterval, the others are updated at LowTickInterval
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance", meta = (ClampMin = 0))
+	int32 MediumSignificanceBudget = 16;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	float MediumTickInterval = 1.f / 20.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	float LowTickInterval = 1.f / 5.f;
+
+	// Enemies farther than this from the view are always low significance
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Significance")
+	float LowSignificanceDistance = 5000.f;
+
+	// Change the budgets, taken into account on the next update
+	UFUNCTION(BlueprintCallable, Category = "Significance")
+	void SetSignificanceBudget(int32 highCount, int32 mediumCount);
+
+private:
+
+	// Enemies sorted by significance, kept to avoid allocating on each update
+	TArray<TPair<double, ABaseGasCharacter*>> _rankedEnemies;
+};
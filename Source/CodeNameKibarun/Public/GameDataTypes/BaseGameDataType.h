@@ -15,6 +15,7 @@ enum class EDataBundleType : uint8
 	UI = 1 << 1 UMETA(ToolTip = "For managed types related to UI like icons, widgets"),
 	Spawn = 1 << 2 UMETA(ToolTip = "For managed types related to placement in the world like meshes, materials or anim bp"),
 	Accessories = 1 << 3 UMETA(ToolTip = "For other managed types"),
+	Proxy = 1 << 4 UMETA(ToolTip = "For the lightweight stand-ins shown before the actor spawns"),
 };
 
 
@@ -22,6 +23,7 @@ enum class EDataBundleType : uint8
 #define BUNDLE_UI "UI"
 #define BUNDLE_SPAWN "Spawn" 
 #define BUNDLE_ACCESSORY "Accessory"
+#define BUNDLE_PROXY "Proxy"
 
 
 USTRUCT(BlueprintType)
@@ -15,6 +15,7 @@ enum class EWaveSpawnMode: uint8
 	OnAllAnchorsFree UMETA(ToolTip="Spawn Wave when all the anchors are free"),
 	OnTwoAnchorsFree UMETA(ToolTip="Spawn Wave when 2 anchors are free"),
 	OnOneAnchorsFree UMETA(ToolTip="Spawn Wave when 1 anchors is free"),
+	Custom UMETA(ToolTip="Spawn Wave when the free anchors reach FreeAnchorCount or FreeAnchorPercent"),
 };
 
 
@@ -30,13 +31,161 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Wave")
 	float SpawnDelay = 0;
+
+	// Free anchors needed to spawn
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Wave", meta=(EditCondition="SpawnMode == EWaveSpawnMode::Custom", EditConditionHides, ClampMin=1))
+	int32 FreeAnchorCount = 1;
+
+	// Fraction of the anchors that must be free to spawn, whichever of the count and the percent is higher
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Wave", meta=(EditCondition="SpawnMode == EWaveSpawnMode::Custom", EditConditionHides, ClampMin=0, ClampMax=1))
+	float FreeAnchorPercent = 0;
+
+	// Only the first spawn of the wave waits for the free anchors, the next ones just need a free anchor
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Wave", meta=(EditCondition="SpawnMode == EWaveSpawnMode::Custom", EditConditionHides))
+	bool bGateFirstSpawnOnly = true;
+
+	// Enemies that can be loading at the same time
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Wave", meta=(ClampMin=1))
+	int32 MaxInFlightSpawns = 1;
+
+	// Enemies spawn requests in a single frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Wave", meta=(ClampMin=1))
+	int32 SpawnBurst = 1;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Wave", meta=(AllowedTypes = "EnemyData"))
 	TArray<FPrimaryAssetId> WaveEnemies;
 	
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category="Wave")
-	bool HasBeganSpawn = false;
-	
+};
+
+
+/**
+ * Runtime scaling of the combats, applied over the authored datas when the wave schedule and stat table are built.
+ * Values grow linearly with the stage index, so one data set can serve scaling and endless modes
+ */
+USTRUCT(BlueprintType)
+struct FCombatDifficulty
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Difficulty", meta=(ClampMin=0))
+	float EnemyHealthMultiplier = 1;
+
+	// Added to the health multiplier at each stage
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Difficulty")
+	float EnemyHealthPerStage = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Difficulty", meta=(ClampMin=0))
+	float EnemySpeedMultiplier = 1;
+
+	// Enemies added to each wave, repeating the wave own enemies
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Difficulty", meta=(ClampMin=0))
+	int32 ExtraEnemiesPerWave = 0;
+
+	// Added to the extra enemies at each stage, rounded down
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Difficulty", meta=(ClampMin=0))
+	float ExtraEnemiesPerStage = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Difficulty", meta=(ClampMin=0))
+	float SpawnDelayMultiplier = 1;
+
+	FORCEINLINE float GetEnemyHealthMultiplier(int32 stageIndex) const { return FMath::Max(0.f, EnemyHealthMultiplier + EnemyHealthPerStage * stageIndex); }
+
+	FORCEINLINE int32 GetExtraEnemies(int32 stageIndex) const { return FMath::Max(0, ExtraEnemiesPerWave + FMath::FloorToInt32(ExtraEnemiesPerStage * stageIndex)); }
+
+	// Whether the schedule of a stage is the authored one
+	FORCEINLINE bool KeepsWaves(int32 stageIndex) const { return GetExtraEnemies(stageIndex) == 0 && SpawnDelayMultiplier == 1; }
+};
+
+
+/**
+ * A wave of a compiled schedule. Its enemies are a range of the schedule enemies array
+ */
+struct FCompiledWave
+{
+	EWaveSpawnMode SpawnMode = EWaveSpawnMode::None;
+	float SpawnDelay = 0;
+	int32 FirstEnemy = 0;
+	int32 EnemyCount = 0;
+	// Spawn rules, the presets modes are turned into these
+	int32 FreeAnchorCount = 1;
+	float FreeAnchorPercent = 0;
+	bool bGateFirstSpawnOnly = false;
+	int32 MaxInFlightSpawns = 1;
+	int32 SpawnBurst = 1;
+
+	// Whether the spawn rules of the wave allow a new enemy with that many free anchors, out of anchorCount
+	FORCEINLINE bool CanSpawn(int32 freeAnchorCount, int32 anchorCount, bool hasBeganSpawn) const
+	{
+		if (SpawnMode == EWaveSpawnMode::None || freeAnchorCount <= 0)
+			return false;
+		if (hasBeganSpawn && bGateFirstSpawnOnly)
+			return true;
+		const int32 required = FMath::Max(FreeAnchorCount, FMath::CeilToInt32(FreeAnchorPercent * anchorCount));
+		return freeAnchorCount >= FMath::Clamp(required, 1, FMath::Max(anchorCount, 1));
+	}
+};
+
+
+/**
+ * Immutable flat version of the enemy waves, built once when the combat data is loaded.
+ * Waves without valid enemies are stripped, so every wave has at least one enemy to spawn.
+ */
+struct CODENAMEKIBARUN_API FCompiledWaveSchedule
+{
+	// All the enemies of all the waves, contiguous and in spawn order
+	TArray<FPrimaryAssetId> Enemies;
+
+	TArray<FCompiledWave> Waves;
+
+	void Compile(const TArray<FEnemyWave>& enemyWaves);
+
+	// Compile with the difficulty of the stage applied
+	void Compile(const TArray<FEnemyWave>& enemyWaves, const FCombatDifficulty& difficulty, int32 stageIndex);
+
+	FORCEINLINE TArrayView<const FPrimaryAssetId> GetWaveEnemies(int32 waveIndex) const
+	{
+		return Waves.IsValidIndex(waveIndex) ? TArrayView<const FPrimaryAssetId>(Enemies.GetData() + Waves[waveIndex].FirstEnemy, Waves[waveIndex].EnemyCount) : TArrayView<const FPrimaryAssetId>();
+	}
+};
+
+
+/**
+ * Runtime position of a combat in a compiled wave schedule
+ */
+struct FWaveCursor
+{
+	int32 WaveIndex = INDEX_NONE;
+	// Next enemy to spawn, relative to the wave first enemy
+	int32 EnemyIndex = 0;
+	bool bHasBeganSpawn = false;
+
+	FORCEINLINE void Reset() { *this = FWaveCursor(); }
+
+	FORCEINLINE const FCompiledWave* GetWave(const FCompiledWaveSchedule& schedule) const { return schedule.Waves.IsValidIndex(WaveIndex) ? &schedule.Waves[WaveIndex] : nullptr; }
+
+	FORCEINLINE bool IsLastWave(const FCompiledWaveSchedule& schedule) const { return WaveIndex >= schedule.Waves.Num() - 1; }
+
+	// Move to the next wave. Stay on the current one and return false if there is no more wave
+	FORCEINLINE bool NextWave(const FCompiledWaveSchedule& schedule)
+	{
+		if (IsLastWave(schedule))
+			return false;
+		WaveIndex++;
+		EnemyIndex = 0;
+		bHasBeganSpawn = false;
+		return true;
+	}
+
+	// Get the next enemy of the current wave. Return false when the wave is exhausted
+	FORCEINLINE bool PopEnemy(const FCompiledWaveSchedule& schedule, FPrimaryAssetId& enemyID)
+	{
+		const FCompiledWave* wave = GetWave(schedule);
+		if (!wave || EnemyIndex >= wave->EnemyCount)
+			return false;
+		enemyID = schedule.Enemies[wave->FirstEnemy + EnemyIndex++];
+		return true;
+	}
 };
 
 
@@ -61,4 +210,18 @@ public:
 	
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = BUNDLE_SPAWN, meta = (AssetBundles = BUNDLE_SPAWN))
 	TSoftObjectPtr<UWorld> CombatMapArea;
+
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	// The enemy waves compiled into a flat schedule
+	const FCompiledWaveSchedule& GetWaveSchedule();
+
+private:
+
+	FCompiledWaveSchedule WaveSchedule;
+	bool bIsScheduleCompiled = false;
 };
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "BaseCharacterData.h"
+#include "Engine/StaticMesh.h"
 #include "EnemyData.generated.h"
 
 /**
@@ -13,4 +14,13 @@ UCLASS(BlueprintType, Blueprintable)
 class CODENAMEKIBARUN_API UEnemyData : public UBaseCharacterData
 {
 	GENERATED_BODY()
+
+public:
+
+	// Instanced stand-in shown while the enemy waits in its wave, before its actor spawns. No proxy when unset
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = BUNDLE_PROXY, meta = (AssetBundles = BUNDLE_PROXY))
+	TSoftObjectPtr<UStaticMesh> ProxyMesh;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = BUNDLE_PROXY)
+	FTransform ProxyTransform = FTransform::Identity;
 };
@@ -0,0 +1,66 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/RootMotionSource.h"
+#include "FCEasing.h"
+#include "RootMotionSource_EasedMoveTo.generated.h"
+
+
+/**
+ * Move a character from a start to a target location following an FCTween easing curve.
+ * Runs inside the movement component integration, so it works at any frame rate and is replicated like any root motion.
+ * Only predicted when the owning client applies the same source, the anchor dash is applied by the server alone.
+ */
+USTRUCT()
+struct CODENAMEKIBARUN_API FRootMotionSource_EasedMoveTo : public FRootMotionSource
+{
+	GENERATED_BODY()
+
+	FRootMotionSource_EasedMoveTo();
+
+	virtual ~FRootMotionSource_EasedMoveTo() override {}
+
+	UPROPERTY()
+	FVector StartLocation = FVector::ZeroVector;
+
+	UPROPERTY()
+	FVector TargetLocation = FVector::ZeroVector;
+
+	// Time before the move starts, included in Duration
+	UPROPERTY()
+	float Delay = 0;
+
+	UPROPERTY()
+	EFCEase Easing = EFCEase::Linear;
+
+	virtual FRootMotionSource* Clone() const override;
+
+	virtual bool Matches(const FRootMotionSource* Other) const override;
+
+	virtual bool MatchesAndHasSameState(const FRootMotionSource* Other) const override;
+
+	virtual bool UpdateStateFrom(const FRootMotionSource* SourceToTakeStateFrom, bool bMarkForSimulatedCatchup = false) override;
+
+	virtual void PrepareRootMotion(float SimulationTime, float MovementTickTime, const ACharacter& Character, const UCharacterMovementComponent& MoveComponent) override;
+
+	virtual bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) override;
+
+	virtual UScriptStruct* GetScriptStruct() const override;
+
+	virtual FString ToSimpleString() const override;
+
+	// Location along the curve at that time of the source
+	FVector GetLocationAtTime(float time) const;
+};
+
+template<>
+struct TStructOpsTypeTraits<FRootMotionSource_EasedMoveTo> : public TStructOpsTypeTraitsBase2<FRootMotionSource_EasedMoveTo>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithCopy = true,
+	};
+};
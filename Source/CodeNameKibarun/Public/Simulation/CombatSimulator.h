@@ -0,0 +1,145 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Actors/CombatManager.h"
+
+
+/**
+ * Parameters of a headless combat simulation. Times are in seconds of simulated time
+ */
+struct FCombatSimulationSettings
+{
+	// Number of enemy anchors of the simulated arena
+	int32 EnemyAnchorCount = 3;
+
+	// Fixed step of the simulation
+	float TickDeltaTime = 1.f / 30.f;
+
+	// Time to load an enemy data before it is spawned
+	float AssetLoadTime = 0.f;
+
+	// Time for a spawned enemy to reach its anchor
+	float TravelTime = 1.5f;
+
+	// Time for an enemy to move up to the next anchor
+	float ShiftTime = 0.5f;
+
+	// Time an enemy survives once on its anchor
+	float EnemyLifeTime = 4.f;
+
+	// Random variation applied to the times above, as a fraction
+	float Jitter = 0.25f;
+
+	// The simulation gives up past this time
+	float MaxSimulatedTime = 3600.f;
+
+	int32 Seed = 0;
+};
+
+
+/**
+ * Outcome of one or several simulations
+ */
+struct CODENAMEKIBARUN_API FCombatSimulationReport
+{
+	int32 Runs = 0;
+	int32 CompletedRuns = 0;
+	int64 Ticks = 0;
+	double WallSeconds = 0;
+	double SimulatedSeconds = 0;
+
+	// Time from a spawn request to the enemy standing on its anchor
+	TArray<float> SpawnLatencies;
+
+	// Time from the start of a wave to the death of its last enemy, indexed by run then wave
+	TArray<TArray<float>> WaveCompletionTimes;
+
+	FORCEINLINE double GetTicksPerSecond() const { return WallSeconds > 0 ? Ticks / WallSeconds : 0; }
+
+	// Percentile of the spawn latencies, percentile in [0, 1]
+	float GetSpawnLatencyPercentile(float percentile) const;
+
+	void Append(const FCombatSimulationReport& other);
+
+	void Reset();
+
+	// Log a summary of the report
+	void Dump(const FString& title) const;
+};
+
+
+/**
+ * Run a compiled wave schedule through the combat phase machine without any world, actor or camera.
+ * Spawns, anchors and formation go through the FCombatRules ACombatManager runs, only the timings are simulated.
+ * Reuse the same simulator to run many times without allocating.
+ */
+class CODENAMEKIBARUN_API FCombatSimulator
+{
+public:
+
+	explicit FCombatSimulator(const FCompiledWaveSchedule& schedule);
+
+	// Run the whole combat once, adding the results to the report
+	bool Run(const FCombatSimulationSettings& settings, FCombatSimulationReport& report);
+
+private:
+
+	enum class EEnemyState : uint8
+	{
+		Loading,
+		Travelling,
+		OnAnchor,
+		Dead,
+	};
+
+	struct FSimEnemy
+	{
+		EEnemyState State = EEnemyState::Loading;
+		int32 Wave = INDEX_NONE;
+		// Anchor kept while loading, then owned. None while held for lack of anchor
+		int32 Anchor = INDEX_NONE;
+		// Last place the enemy stood: its spawn point, then the anchors it reached
+		FVector Location = FVector::ZeroVector;
+		// Remaining loading or travelling time
+		float Timer = 0;
+		// Remaining time on anchor
+		float Life = 0;
+		float RequestTime = 0;
+		bool bReachedOnce = false;
+	};
+
+	struct FSimWave
+	{
+		float StartTime = 0;
+		int32 Dead = 0;
+	};
+
+	const FCompiledWaveSchedule& Schedule;
+
+	FCombatSimulationSettings Settings;
+	FRandomStream Stream;
+	ECombatPhase Phase = ECombatPhase::Opening;
+	FWaveCursor Cursor;
+	TArray<FSimEnemy> Enemies;
+	// Enemy anchors laid on a line, front-most first, with the enemy owning each
+	TArray<FCombatAnchorSlot> Anchors;
+	TArray<int32> AnchorOwners;
+	FVector SpawnLocation = FVector::ZeroVector;
+	FCombatRules Rules;
+	TArray<TPair<int32, int32>> FormationMoves;
+	bool bIsFormationDirty = false;
+	TArray<FSimWave> Waves;
+	float Time = 0;
+	float SpawnTimer = 0;
+	int32 InFlightSpawns = 0;
+
+	float Vary(float value);
+	void Tick(float deltaTime, FCombatSimulationReport& report, TArray<float>& waveTimes);
+	void SetAnchorOwner(int32 anchor, int32 enemyIndex);
+	void SolveFormation();
+	void TrySpawnEnemy();
+	void CreateNextWave();
+	int32 CountAlive() const;
+};
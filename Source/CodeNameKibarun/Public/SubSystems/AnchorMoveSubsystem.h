@@ -0,0 +1,94 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "AITypes.h"
+#include "AnchorMoveSubsystem.generated.h"
+
+
+class ABaseGasCharacter;
+class AController;
+class UPathFollowingComponent;
+struct FPathFollowingResult;
+
+
+/**
+ * A pending anchor move of a character
+ */
+struct FAnchorMoveRequest
+{
+	TWeakObjectPtr<ABaseGasCharacter> Character;
+
+	FVector Goal = FVector::ZeroVector;
+
+	float AcceptanceRadius = 0;
+
+	// The async path query resolving this request, INVALID_NAVQUERYID until it is issued
+	uint32 QueryID = INVALID_NAVQUERYID;
+
+	// Waiting in the queue for its turn
+	bool bIsQueued = false;
+};
+
+
+/**
+ * AnchorMoveSubsystem batches the Walk and Run anchor moves of the characters.
+ * Requests are queued and resolved a few per frame: a straight nav raycast first, an async path query when the anchor is not directly reachable.
+ * The path is then followed by the controller path following component, a crowd following one (e.g. ADetourAIController) adds avoidance.
+ * A new request of a character replaces its pending one.
+ */
+UCLASS()
+class CODENAMEKIBARUN_API UAnchorMoveSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+private:
+
+	// Pending requests, by character
+	TMap<TObjectKey<ABaseGasCharacter>, FAnchorMoveRequest> _requests;
+
+	// Characters waiting for their request to be processed, oldest first
+	TArray<TObjectKey<ABaseGasCharacter>> _queue;
+
+	// The character of each async path query in flight
+	TMap<uint32, TObjectKey<ABaseGasCharacter>> _pathQueries;
+
+	// The move each character is following, to tell its completion from older moves
+	TMap<TObjectKey<ABaseGasCharacter>, FAIRequestID> _activeMoves;
+
+	// Path following components already bound to OnMoveFinished_Internal
+	TSet<TObjectKey<UPathFollowingComponent>> _boundFollowers;
+
+	// Resolve one request, returns true while an async path query is searching for it
+	bool ProcessRequest(const TObjectKey<ABaseGasCharacter>& key, FAnchorMoveRequest& request);
+
+	void OnPathFound_Internal(uint32 queryID, ENavigationQueryResult::Type result, FNavPathSharedPtr path);
+
+	void OnMoveFinished_Internal(FAIRequestID requestID, const FPathFollowingResult& result, TWeakObjectPtr<AController> controller);
+
+	// Follow the path, returns false if the character has no controller to follow it
+	bool StartMove(ABaseGasCharacter* character, const FAnchorMoveRequest& request, FNavPathSharedPtr path);
+
+	UPathFollowingComponent* FindPathFollowing(AController* controller);
+
+public:
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual bool IsTickable() const override { return !_queue.IsEmpty(); }
+
+	virtual TStatId GetStatId() const override;
+
+	// Queue a move of the character to the location, replacing its pending one
+	void RequestAnchorMove(ABaseGasCharacter* Character, const FVector& Goal, float AcceptanceRadius = 0);
+
+	// Drop the pending move of the character, a move already being followed is left alone
+	void CancelAnchorMove(ABaseGasCharacter* Character);
+
+	UFUNCTION(BlueprintPure, Category = "Combat|Movement")
+	FORCEINLINE int32 GetPendingMoveCount() const { return _requests.Num(); }
+};
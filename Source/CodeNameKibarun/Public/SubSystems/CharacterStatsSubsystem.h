@@ -0,0 +1,120 @@
+// Copyright TyniBoat 2025, All Rights reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "GameDataTypes/BaseGameDataType.h"
+#include "CharacterStatsSubsystem.generated.h"
+
+
+class UBaseCharacterData;
+struct FCombatDifficulty;
+
+
+/**
+ * Multipliers applied over the stats of a character data, for upgrades and difficulty scaling
+ */
+USTRUCT(BlueprintType)
+struct FCharacterStatModifiers
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stats")
+	float MaxHealthMultiplier = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stats")
+	float SpeedMultiplier = 1;
+
+	FCharacterStatModifiers& operator*=(const FCharacterStatModifiers& other)
+	{
+		MaxHealthMultiplier *= other.MaxHealthMultiplier;
+		SpeedMultiplier *= other.SpeedMultiplier;
+		return *this;
+	}
+};
+
+
+/**
+ * Final stats of a character data, with its upgrades and the scaling applied
+ */
+USTRUCT(BlueprintType)
+struct FCompiledCharacterStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Stats")
+	float MaxHealth = 100;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Stats")
+	float WalkSpeed = 250;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Stats")
+	float RunSpeed = 450;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Stats")
+	float SprintSpeed = 600;
+};
+
+
+/**
+ * CharacterStatsSubsystem compiles the stats of the character datas into a flat table.
+ * Characters keep an index in the table, index 0 holds the default stats for characters without data.
+ * Upgrades are set per data, scaling per side (heroes, enemies), both are multiplied over the authored stats.
+ * Characters read their stats when they need them, so a change applies to the next spawn and movement speed switch.
+ */
+UCLASS()
+class CODENAMEKIBARUN_API UCharacterStatsSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+private:
+
+	// Final stats, read by the characters
+	TArray<FCompiledCharacterStats> _stats;
+
+	// Authored stats and upgrades, the table is rebuilt from them
+	TArray<FCharacterStats> _baseStats;
+	TArray<FCharacterStatModifiers> _upgrades;
+	TBitArray<> _isEnemy;
+
+	TMap<TObjectKey<UBaseCharacterData>, int32> _indices;
+
+	FCharacterStatModifiers _heroScaling;
+	FCharacterStatModifiers _enemyScaling;
+
+	void CompileEntry(int32 index);
+
+public:
+
+	static constexpr int32 DefaultStatsIndex = 0;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	// The index of the data stats, compiled on first use
+	int32 RegisterCharacterData(const UBaseCharacterData* Data);
+
+	// Compile every character data currently in memory
+	UFUNCTION(BlueprintCallable, Category = "Stats")
+	void CompileLoadedCharacterData();
+
+	FORCEINLINE const FCompiledCharacterStats& GetStats(int32 Index) const { return _stats.IsValidIndex(Index) ? _stats[Index] : _stats[DefaultStatsIndex]; }
+
+	UFUNCTION(BlueprintPure, Category = "Stats")
+	FCompiledCharacterStats GetCharacterDataStats(const UBaseCharacterData* Data) const;
+
+	// Multiply the stats of a character data, replacing its previous upgrade
+	UFUNCTION(BlueprintCallable, Category = "Stats")
+	void SetUpgrade(const UBaseCharacterData* Data, FCharacterStatModifiers Upgrade);
+
+	// Rebalance every hero and enemy in one pass
+	UFUNCTION(BlueprintCallable, Category = "Stats")
+	void SetScaling(FCharacterStatModifiers HeroScaling, FCharacterStatModifiers EnemyScaling);
+
+	// Scale the enemies for a difficulty at a stage, heroes keep their authored stats
+	void SetDifficulty(const FCombatDifficulty& Difficulty, int32 StageIndex);
+
+	UFUNCTION(BlueprintPure, Category = "Stats")
+	FORCEINLINE int32 GetStatCount() const { return _stats.Num(); }
+};
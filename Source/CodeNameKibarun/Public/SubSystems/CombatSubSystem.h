@@ -4,12 +4,19 @@
 
 #include "CoreMinimal.h"
 #include "Actors/CombatManager.h"
+#include "UObject/ObjectKey.h"
+#include "Combat/CombatUIFeed.h"
 #include "CombatSubSystem.generated.h"
 
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCombatUIFeedSignature, const TArray<FCombatUIChange>&, Changes);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnCombatUIFeedNativeSignature, TConstArrayView<FCombatUIChange>);
+
+
 /**
  * CombatSubSystem is responsible for managing combat-related functionalities in the game.
  * It handles combat mechanics, player interactions, and combat state management.
+ * Several combats can run in the same world, each actor taking part in a combat is registered to it.
  */
 UCLASS()
 class CODENAMEKIBARUN_API UCombatSubSystem : public UWorldSubsystem
@@ -19,13 +26,94 @@ class CODENAMEKIBARUN_API UCombatSubSystem : public UWorldSubsystem
 private:
 	
 	UPROPERTY(VisibleDefaultsOnly, Category="Combat")
-	TObjectPtr<ACombatManager> _combatManager;
+	TArray<TObjectPtr<ACombatManager>> _combatManagers;
+
+	// The combat owning each registered actor
+	TMap<TObjectKey<AActor>, TWeakObjectPtr<ACombatManager>> _actorCombats;
+
+	// Snapped anchor world locations, by combat snap key
+	TMap<FAnchorSnapKey, TArray<FVector>> _anchorSnaps;
+
+	// UI changes collected this frame, one per character
+	TArray<FCombatUIChange> _uiChanges;
+	TMap<TObjectKey<ABaseGasCharacter>, int32> _uiChangeIndices;
+
+	// The changes of the last published frame
+	TArray<FCombatUIChange> _uiFeed;
+	bool _isUIFeedScheduled = false;
+
+	void PublishUIFeed_Internal();
 
 public:
 
+	// The first registered combat manager
 	UFUNCTION(BlueprintPure, Category = "Combat", meta = (CompactNodeTitle = "CombatManager"))
-	FORCEINLINE ACombatManager* GetCombatManager() const { return _combatManager; }
+	FORCEINLINE ACombatManager* GetCombatManager() const { return _combatManagers.IsEmpty() ? nullptr : _combatManagers[0].Get(); }
+
+	UFUNCTION(BlueprintPure, Category = "Combat", meta = (CompactNodeTitle = "CombatManagers"))
+	FORCEINLINE TArray<ACombatManager*> GetCombatManagers() const { return ObjectPtrDecay(_combatManagers); }
 
+	// Register a combat manager, kept for compatibility with a single combat per world
 	UFUNCTION(BlueprintCallable, Category = "Combat")
 	void SetCombatManager(ACombatManager* NewCombatManager);
+
+	UFUNCTION(BlueprintCallable, Category = "Combat")
+	void RegisterCombatManager(ACombatManager* CombatManager);
+
+	// Unregister a combat manager and all its actors
+	UFUNCTION(BlueprintCallable, Category = "Combat")
+	void UnregisterCombatManager(ACombatManager* CombatManager);
+
+	void RegisterCombatActor(AActor* Actor, ACombatManager* CombatManager);
+
+	void UnregisterCombatActor(AActor* Actor);
+
+	// The combat the actor takes part in, if any
+	UFUNCTION(BlueprintPure, Category = "Combat")
+	ACombatManager* GetCombatOfActor(const AActor* Actor) const;
+
+	FORCEINLINE const TArray<FVector>* FindAnchorSnap(const FAnchorSnapKey& SnapKey) const { return _anchorSnaps.Find(SnapKey); }
+
+	FORCEINLINE void StoreAnchorSnap(const FAnchorSnapKey& SnapKey, const TArray<FVector>& Locations) { _anchorSnaps.Add(SnapKey, Locations); }
+
+	// Forget the snapped anchors, for when the arena geometry changed
+	UFUNCTION(BlueprintCallable, Category = "Combat")
+	void InvalidateAnchorSnaps() { _anchorSnaps.Reset(); }
+
+
+	// UI feed ______________________________________________________________________________________________________________________________________
+
+	// Fired once per frame with every character change of the frame
+	UPROPERTY(BlueprintAssignable, Category = "Combat|UI")
+	FOnCombatUIFeedSignature OnCombatUIFeed;
+
+	FOnCombatUIFeedNativeSignature OnCombatUIFeedNative;
+
+	// The changes published last frame, empty if nothing changed
+	UFUNCTION(BlueprintPure, Category = "Combat|UI")
+	FORCEINLINE TArray<FCombatUIChange> GetCombatUIFeed() const { return _uiFeed; }
+
+	FORCEINLINE TConstArrayView<FCombatUIChange> GetCombatUIFeedView() const { return _uiFeed; }
+
+	// Merge a character change into this frame feed. The old health of the frame is kept, the rest is overwritten
+	void ReportUIChange(ABaseGasCharacter* Character, float OldHealth, float NewHealth, float MaxHealth, ECombatUIChangeFlags Flags);
+
+
+	// Targeting ____________________________________________________________________________________________________________________________________
+
+	// The closest anchors or characters of the combat, nearest first. The first combat is used when none is given
+	UFUNCTION(BlueprintCallable, Category = "Combat|Targeting")
+	TArray<UObject*> FindNearestInCombat(ACombatManager* Combat, FVector Location, int32 Count, UPARAM(meta = (Bitmask, BitmaskEnum = "/Script/CodeNameKibarun.ECombatSpatialKind")) int32 Kinds, float MaxRadius = 5000);
+
+	// The anchors or characters of the combat within the radius
+	UFUNCTION(BlueprintCallable, Category = "Combat|Targeting")
+	TArray<UObject*> FindInCombatRadius(ACombatManager* Combat, FVector Location, float Radius, UPARAM(meta = (Bitmask, BitmaskEnum = "/Script/CodeNameKibarun.ECombatSpatialKind")) int32 Kinds);
+
+	// The anchors or characters of the combat inside the cone, nearest first
+	UFUNCTION(BlueprintCallable, Category = "Combat|Targeting")
+	TArray<UObject*> FindInCombatCone(ACombatManager* Combat, FVector Origin, FVector Direction, float HalfAngle, float Length, UPARAM(meta = (Bitmask, BitmaskEnum = "/Script/CodeNameKibarun.ECombatSpatialKind")) int32 Kinds);
+
+	// The first free anchor of the combat met along the line
+	UFUNCTION(BlueprintCallable, Category = "Combat|Targeting")
+	UCharacterAnchor* FindFirstFreeAnchorAlongLine(ACombatManager* Combat, FVector Start, FVector End, float Radius, bool bEnemyAnchors = true);
 };
@@ -5,15 +5,33 @@
 #include "GameDataTypes/CombatData.h"
 #include "Kismet/BlueprintAsyncActionBase.h"
 #include "Engine/GameInstance.h"
+#include "Engine/StreamableManager.h"
 #include "LevelSubsystem.generated.h"
 
 
+/**
+ * A stage loaded ahead of time. The handles keep its assets in memory until the stage is passed.
+ */
+struct FStagePreload
+{
+	// The combat data with its infos and spawn bundles (traversals, map area)
+	TSharedPtr<FStreamableHandle> StageHandle;
+
+	// The enemies of the stage first wave
+	TSharedPtr<FStreamableHandle> EnemiesHandle;
+
+	// Rough memory cost of the stage, filled once everything is loaded
+	int64 EstimatedBytes = 0;
+
+	bool bStageLoaded = false;
+	bool bIsLoaded = false;
+};
 
 
 /**
  * LevelSubsystem handle level stages
  */
-UCLASS()
+UCLASS(Config = Game)
 class CODENAMEKIBARUN_API ULevelSubsystem : public UGameInstanceSubsystem
 {
 	GENERATED_BODY()
@@ -23,8 +41,37 @@ private:
 	UPROPERTY(VisibleDefaultsOnly, Category = "Level")
 	FLevelStageCollection _stageCollection;
 
+	// Stages loaded ahead of the current one
+	TMap<FPrimaryAssetId, FStagePreload> _preloadedStages;
+
+	// The stage being preloaded right now. Only one stage is preloaded at a time
+	FPrimaryAssetId _preloadingStage;
+
+	void OnStagePreloaded_Internal(FPrimaryAssetId stageID);
+
+	void OnStageEnemiesPreloaded_Internal(FPrimaryAssetId stageID);
+
+	// Drop the preloads of the stages behind the current one
+	void ReleasePassedStages();
+
+	UPROPERTY(VisibleDefaultsOnly, Category = "Level|Difficulty")
+	FCombatDifficulty _difficulty;
+
+	// Push the enemy scaling of the current stage to the stat table
+	void ApplyDifficultyScaling();
+
 public:
 
+	// How many stages ahead of the current one can be preloaded
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, Category = "Level|Preload")
+	int32 MaxPreloadedStages = 2;
+
+	// Memory budget (MB) of the preloaded stages. No further stage is preloaded once it is exceeded
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, Category = "Level|Preload")
+	int32 PreloadMemoryBudgetMB = 256;
+
+	virtual void Deinitialize() override;
+
 	UFUNCTION(BlueprintPure, Category = "Level", meta = (CompactNodeTitle = "Stages"))
 	FORCEINLINE FLevelStageCollection GetStageCollection() const { return _stageCollection; }
 
@@ -40,6 +87,15 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Level")
 	FORCEINLINE FPrimaryAssetId GetCurrentStage() const { return _stageCollection.Combats.IsValidIndex(_stageCollection.StageIndex) ? _stageCollection.Combats[_stageCollection.StageIndex] : FPrimaryAssetId(); }
 
+	UFUNCTION(BlueprintPure, Category = "Level|Difficulty")
+	FORCEINLINE FCombatDifficulty GetDifficulty() const { return _difficulty; }
+
+	FORCEINLINE const FCombatDifficulty& GetDifficultyRef() const { return _difficulty; }
+
+	// Scale the next combats. A combat already running keeps its waves
+	UFUNCTION(BlueprintCallable, Category = "Level|Difficulty")
+	void SetDifficulty(const FCombatDifficulty& Difficulty);
+
 	// Load a level
 	bool SetLevel(ULevelData* levelDatas);
 
@@ -51,6 +107,20 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Level")
 	bool MoveToStage(int32 increment);
 
+	// Start loading the next stages in the background, as far as the memory budget allows
+	UFUNCTION(BlueprintCallable, Category = "Level|Preload")
+	void PreloadUpcomingStages();
+
+	// Get the combat data of a stage if it has been fully preloaded, null otherwise
+	UFUNCTION(BlueprintPure, Category = "Level|Preload")
+	UCombatData* GetPreloadedStage(UPARAM(meta = (AllowedTypes = "CombatData")) FPrimaryAssetId stageID) const;
+
+	// Estimated memory used by the preloaded stages, in bytes
+	int64 GetPreloadedBytes() const;
+
+	// Release every preloaded stage
+	UFUNCTION(BlueprintCallable, Category = "Level|Preload")
+	void ReleasePreloadedStages();
 };
 
 